@@ -1,8 +1,13 @@
 #pragma once
 
+#include "soci-wrapper/async.hpp"
+#include "soci-wrapper/batch_executor.hpp"
 #include "soci-wrapper/configuration.hpp"
 #include "soci-wrapper/ddl.hpp"
 #include "soci-wrapper/dml.hpp"
 #include "soci-wrapper/dql.hpp"
+#include "soci-wrapper/kernels.hpp"
+#include "soci-wrapper/rw_sessions_pool.hpp"
 #include "soci-wrapper/session.hpp"
 #include "soci-wrapper/sessions_pool.hpp"
+#include "soci-wrapper/write_behind.hpp"
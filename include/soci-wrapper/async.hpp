@@ -0,0 +1,208 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "base/thread_pool.hpp"
+#include "dml.hpp"
+#include "dql.hpp"
+#include "sessions_pool.hpp"
+
+namespace soci_wrapper {
+
+/*! \brief Coroutine awaitables running the queries on a worker thread pool
+ *
+ *  An awaitable posts its job to an executor, the worker borrows a session from the sessions_pool,
+ *  runs the job, returns the session and resumes the awaiting coroutine. Thus the calling thread
+ *  (e.g. an event loop) is never blocked by the database and the in-flight requests share the sessions
+ *  of the pool. The coroutine is resumed on the worker thread.
+ */
+namespace async {
+
+    using executor = base::thread_pool;
+
+    /*! \fn executor& default_executor()
+     *  \brief Returns the executor used when none is given, it has a worker per hardware thread
+     */
+    inline executor& default_executor()
+    {
+        static executor instance;
+        return instance;
+    }
+
+    /*! \brief The time a worker waits for a busy session of the pool before the operation fails
+     */
+    inline constexpr std::chrono::milliseconds default_session_timeout { std::chrono::seconds { 30 } };
+
+    /*! \brief An awaitable of a \a Job called with a session of the pool
+     *
+     *  If no session is released within the timeout, e.g. the pool is exhausted or its sessions are broken,
+     *  await_resume() throws std::runtime_error and the worker is freed.
+     */
+    template <class Session, class Job>
+    class operation {
+    public:
+        using pool_ptr_type = typename sessions_pool<Session>::ptr_type;
+
+        using session_raw_type = typename Session::session_type;
+
+        using result_type = std::invoke_result_t<Job&, session_raw_type&>;
+
+        operation(executor& executor, pool_ptr_type pool, Job job, std::chrono::milliseconds timeout = default_session_timeout)
+            : m_executor(executor)
+            , m_pool(std::move(pool))
+            , m_job(std::move(job))
+            , m_timeout(timeout)
+            , m_result()
+            , m_error()
+        {
+        }
+
+        operation(const operation&) = delete;
+
+        operation& operator=(const operation&) = delete;
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> caller)
+        {
+            m_executor.post([this, caller] {
+                execute();
+                caller.resume();
+            });
+        }
+
+        result_type await_resume()
+        {
+            if (m_error)
+                std::rethrow_exception(m_error);
+            if constexpr (not std::is_void_v<result_type>)
+                return std::move(*m_result);
+        }
+
+    private:
+        using storage_type = std::conditional_t<std::is_void_v<result_type>, std::monostate, std::optional<result_type>>;
+
+        void execute() noexcept
+        {
+            try {
+                // The worker blocks instead of the caller while all the sessions are busy
+                auto session = m_pool->get_session(m_timeout);
+                if (not session)
+                    throw std::runtime_error("No session of the pool is available");
+
+                if constexpr (std::is_void_v<result_type>)
+                    std::invoke(m_job, static_cast<session_raw_type&>(*session));
+                else
+                    m_result.emplace(std::invoke(m_job, static_cast<session_raw_type&>(*session)));
+            } catch (...) {
+                m_error = std::current_exception();
+            }
+        }
+
+        executor& m_executor;
+        pool_ptr_type m_pool;
+        Job m_job;
+        const std::chrono::milliseconds m_timeout;
+        storage_type m_result;
+        std::exception_ptr m_error;
+    };
+
+    /*! \fn auto run(executor& executor, const std::shared_ptr<sessions_pool<Session>>& pool, Job job, std::chrono::milliseconds timeout)
+     *  \brief Returns an awaitable of the \a job called with a session of the \a pool on the \a executor
+     *  \param timeout The time the worker waits for a busy session, the awaitable throws std::runtime_error then
+     */
+    template <class Session, class Job>
+    auto run(executor& executor, const std::shared_ptr<sessions_pool<Session>>& pool, Job job,
+        std::chrono::milliseconds timeout = default_session_timeout)
+    {
+        return operation<Session, Job>(executor, pool, std::move(job), timeout);
+    }
+
+    template <class Session, class Job>
+    auto run(const std::shared_ptr<sessions_pool<Session>>& pool, Job job)
+    {
+        return run(default_executor(), pool, std::move(job));
+    }
+
+    /*! \fn auto objects(executor& executor, const std::shared_ptr<sessions_pool<Session>>& pool, query::from<Type> query)
+     *  \brief Returns an awaitable of the objects selected by the \a query
+     */
+    template <class Session, class Type>
+    auto objects(executor& executor, const std::shared_ptr<sessions_pool<Session>>& pool, query::from<Type> query)
+    {
+        return run(executor, pool, [query = std::move(query)](typename Session::session_type& session) mutable {
+            return query.objects(session);
+        });
+    }
+
+    template <class Session, class Type>
+    auto objects(const std::shared_ptr<sessions_pool<Session>>& pool, query::from<Type> query)
+    {
+        return objects(default_executor(), pool, std::move(query));
+    }
+
+    /*! \fn auto object(executor& executor, const std::shared_ptr<sessions_pool<Session>>& pool, query::from<Type> query)
+     *  \brief Returns an awaitable of the first object selected by the \a query
+     */
+    template <class Session, class Type>
+    auto object(executor& executor, const std::shared_ptr<sessions_pool<Session>>& pool, query::from<Type> query)
+    {
+        return run(executor, pool, [query = std::move(query)](typename Session::session_type& session) mutable {
+            return query.object(session);
+        });
+    }
+
+    template <class Session, class Type>
+    auto object(const std::shared_ptr<sessions_pool<Session>>& pool, query::from<Type> query)
+    {
+        return object(default_executor(), pool, std::move(query));
+    }
+
+    /*! \fn auto count(executor& executor, const std::shared_ptr<sessions_pool<Session>>& pool, query::from<Type> query)
+     *  \brief Returns an awaitable of the number of the rows selected by the \a query
+     */
+    template <class Session, class Type>
+    auto count(executor& executor, const std::shared_ptr<sessions_pool<Session>>& pool, query::from<Type> query)
+    {
+        return run(executor, pool, [query = std::move(query)](typename Session::session_type& session) mutable {
+            return query.count(session);
+        });
+    }
+
+    template <class Session, class Type>
+    auto count(const std::shared_ptr<sessions_pool<Session>>& pool, query::from<Type> query)
+    {
+        return count(default_executor(), pool, std::move(query));
+    }
+
+    /*! \fn auto persist(executor& executor, const std::shared_ptr<sessions_pool<Session>>& pool, Value value)
+     *  \brief Returns an awaitable persisting the \a value, either an object or a range of objects
+     */
+    template <class Session, class Value>
+    auto persist(executor& executor, const std::shared_ptr<sessions_pool<Session>>& pool, Value value)
+    {
+        return run(executor, pool, [value = std::move(value)](typename Session::session_type& session) {
+            dml::persist(session, value);
+        });
+    }
+
+    template <class Session, class Value>
+    auto persist(const std::shared_ptr<sessions_pool<Session>>& pool, Value value)
+    {
+        return persist(default_executor(), pool, std::move(value));
+    }
+
+} // namespace async
+} // namespace soci_wrapper
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace soci_wrapper {
+namespace base {
+
+    /*! \brief A bounded lock-free multi-producer multi-consumer queue
+     *
+     *  A ring of cells, each tagged by a sequence number telling whether the cell is ready
+     *  to be written or to be read at the current lap (D. Vyukov's bounded MPMC queue).
+     *  No allocation happens after the construction; the capacity is rounded up to a power of two.
+     */
+    template <class Type>
+    class bounded_queue {
+    public:
+        using value_type = Type;
+
+        explicit bounded_queue(std::size_t capacity)
+            : m_mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1)
+            , m_cells(std::make_unique<cell[]>(m_mask + 1))
+            , m_enqueue_pos(0)
+            , m_dequeue_pos(0)
+        {
+            for (std::size_t idx = 0; idx <= m_mask; ++idx) {
+                m_cells[idx].sequence.store(idx, std::memory_order_relaxed);
+            }
+        }
+
+        bounded_queue(const bounded_queue&) = delete;
+
+        bounded_queue& operator=(const bounded_queue&) = delete;
+
+        /*! \fn bool try_push(Value&& value)
+         *  \brief Enqueues the \a value unless the queue is full
+         *  \return true if the value was enqueued; otherwise - false, the value is left untouched
+         */
+        template <class Value>
+        bool try_push(Value&& value)
+        {
+            cell* target;
+            std::size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            for (;;) {
+                target = &m_cells[pos & m_mask];
+                const std::size_t sequence = target->sequence.load(std::memory_order_acquire);
+                const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+                if (diff == 0) {
+                    if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = m_enqueue_pos.load(std::memory_order_relaxed);
+                }
+            }
+
+            target->value = std::forward<Value>(value);
+            target->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        /*! \fn bool try_pop(value_type& value)
+         *  \brief Dequeues the oldest element into the \a value unless the queue is empty
+         *  \return true if an element was dequeued; otherwise - false
+         */
+        bool try_pop(value_type& value)
+        {
+            cell* target;
+            std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            for (;;) {
+                target = &m_cells[pos & m_mask];
+                const std::size_t sequence = target->sequence.load(std::memory_order_acquire);
+                const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+                if (diff == 0) {
+                    if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = m_dequeue_pos.load(std::memory_order_relaxed);
+                }
+            }
+
+            value = std::move(target->value);
+            target->sequence.store(pos + m_mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        std::size_t capacity() const
+        {
+            return m_mask + 1;
+        }
+
+        /*! \fn std::size_t size() const
+         *  \brief Returns an approximate number of the enqueued elements
+         */
+        std::size_t size() const
+        {
+            const std::size_t enqueued = m_enqueue_pos.load(std::memory_order_relaxed);
+            const std::size_t dequeued = m_dequeue_pos.load(std::memory_order_relaxed);
+            return enqueued > dequeued ? enqueued - dequeued : 0;
+        }
+
+    private:
+        static constexpr std::size_t cache_line_size = 64;
+
+        struct cell {
+            std::atomic<std::size_t> sequence;
+            value_type value;
+        };
+
+        const std::size_t m_mask;
+        const std::unique_ptr<cell[]> m_cells;
+        alignas(cache_line_size) std::atomic<std::size_t> m_enqueue_pos;
+        alignas(cache_line_size) std::atomic<std::size_t> m_dequeue_pos;
+    };
+
+} // namespace base
+} // namespace soci_wrapper
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -15,6 +16,8 @@ namespace config {
         using foreign_key_value_type = std::pair<std::string_view, std::string_view>;
         using foreign_key_container_type = std::unordered_map<std::string, foreign_key_value_type>;
 
+        using flags_type = std::array<bool, details::type_meta_data<Type>::fields_number::value>;
+
         static container_type& not_null()
         {
             static container_type values;
@@ -33,12 +36,24 @@ namespace config {
             return values;
         }
 
+        static flags_type& primary_key_flags()
+        {
+            static flags_type values {};
+            return values;
+        }
+
         static container_type& auto_increment()
         {
             static container_type values;
             return values;
         }
 
+        static flags_type& auto_increment_flags()
+        {
+            static flags_type values {};
+            return values;
+        }
+
         static foreign_key_container_type& foreign_key()
         {
             static foreign_key_container_type values;
@@ -107,6 +122,7 @@ namespace config {
         result_type operator()(boost::proto::tag::terminal, placeholder::query_placeholder<Idx>) const
         {
             field_name = details::type_meta_data<Type>::member_names()[Idx];
+            field_index = Idx;
             return true;
         }
 
@@ -125,12 +141,14 @@ namespace config {
         result_type operator()(boost::proto::tag::terminal, const primary_key_constraint&) const
         {
             configuration_attributes<Type>::primary_key().emplace(field_name);
+            configuration_attributes<Type>::primary_key_flags()[field_index] = true;
             return true;
         }
 
         result_type operator()(boost::proto::tag::terminal, const auto_increment_constraint&) const
         {
             configuration_attributes<Type>::auto_increment().emplace(field_name);
+            configuration_attributes<Type>::auto_increment_flags()[field_index] = true;
             return true;
         }
 
@@ -151,6 +169,7 @@ namespace config {
         }
 
         mutable std::string_view field_name {};
+        mutable size_t field_index {};
     };
 
 } // namespace config
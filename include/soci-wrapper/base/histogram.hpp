@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace soci_wrapper {
+namespace base {
+
+    /*! \brief A lock-free histogram of durations
+     *
+     *  The durations are counted in nanoseconds by power of two buckets: the bucket N holds the values
+     *  of N significant bits, i.e. [2^(N-1), 2^N). Recording is a few relaxed atomic increments, no allocation.
+     */
+    class log2_histogram {
+    public:
+        static constexpr std::size_t buckets_number = 64;
+
+        using duration_type = std::chrono::nanoseconds;
+
+        /*! \brief A copy of the histogram counters
+         */
+        struct snapshot_type {
+            std::array<std::uint64_t, buckets_number> buckets {};
+            std::uint64_t count = 0;
+            duration_type sum {};
+
+            /*! \fn static duration_type upper_bound(std::size_t bucket)
+             *  \brief Returns the exclusive upper bound of the values counted by the \a bucket
+             */
+            static duration_type upper_bound(std::size_t bucket)
+            {
+                return duration_type { bucket + 1 < buckets_number ? (std::int64_t { 1 } << bucket) : INT64_MAX };
+            }
+
+            /*! \fn duration_type percentile(double ratio) const
+             *  \brief Returns the upper bound of the bucket where the \a ratio of the values is reached
+             *  \param ratio The percentile in the range (0, 1], e.g. 0.99
+             */
+            duration_type percentile(double ratio) const
+            {
+                if (count == 0)
+                    return {};
+
+                const double threshold = ratio * count;
+                std::uint64_t accumulated = 0;
+                for (std::size_t bucket = 0; bucket < buckets_number; ++bucket) {
+                    accumulated += buckets[bucket];
+                    if (accumulated >= threshold and accumulated > 0)
+                        return upper_bound(bucket);
+                }
+                return upper_bound(buckets_number - 1);
+            }
+
+            duration_type mean() const
+            {
+                return count ? sum / static_cast<std::int64_t>(count) : duration_type {};
+            }
+        };
+
+        log2_histogram()
+            : m_buckets {}
+            , m_count(0)
+            , m_sum(0)
+        {
+        }
+
+        log2_histogram(const log2_histogram&) = delete;
+
+        log2_histogram& operator=(const log2_histogram&) = delete;
+
+        void record(duration_type value)
+        {
+            const std::uint64_t ns = value.count() > 0 ? static_cast<std::uint64_t>(value.count()) : 0;
+            const std::size_t bucket = std::min<std::size_t>(std::bit_width(ns), buckets_number - 1);
+
+            m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+            m_count.fetch_add(1, std::memory_order_relaxed);
+            m_sum.fetch_add(ns, std::memory_order_relaxed);
+        }
+
+        snapshot_type snapshot() const
+        {
+            snapshot_type result;
+            for (std::size_t bucket = 0; bucket < buckets_number; ++bucket) {
+                result.buckets[bucket] = m_buckets[bucket].load(std::memory_order_relaxed);
+            }
+            result.count = m_count.load(std::memory_order_relaxed);
+            result.sum = duration_type { static_cast<std::int64_t>(m_sum.load(std::memory_order_relaxed)) };
+            return result;
+        }
+
+    private:
+        std::array<std::atomic<std::uint64_t>, buckets_number> m_buckets;
+        std::atomic<std::uint64_t> m_count;
+        std::atomic<std::uint64_t> m_sum;
+    };
+
+} // namespace base
+} // namespace soci_wrapper
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cassert>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "soci/soci.h"
+
+namespace soci_wrapper {
+namespace base {
+
+    /*! \brief A LRU cache of the prepared statements
+     *
+     *  Maps an SQL text onto a prepared soci::statement. Once the statement is found,
+     *  the previous bindings are dropped and the new ones are attached, so the statement
+     *  is not parsed again by the DB. The least recently used statement is evicted
+     *  when the capacity is exceeded. The statements belong to the connection of the session,
+     *  the cache is to be cleared before it is closed or reconnected, see details::cached_session.
+     */
+    class statement_cache {
+    public:
+        using statement_type = soci::statement;
+
+        static constexpr size_t default_capacity = 32;
+
+        explicit statement_cache(size_t capacity = default_capacity)
+            : m_entries {}
+            , m_index {}
+            , m_capacity(capacity)
+            , m_hits(0)
+            , m_misses(0)
+        {
+            assert(m_capacity > 0);
+        }
+
+        statement_cache(const statement_cache&) = delete;
+
+        statement_cache& operator=(const statement_cache&) = delete;
+
+        /*! \fn statement_type& prepare(soci::session& session, std::string_view sql, Binder&& binder)
+         *  \brief Returns a prepared statement for the \a sql bound by the \a binder
+         *  \param session The session the statement belongs to
+         *  \param sql The SQL text, the key of the cache
+         *  \param binder A callable taking statement_type& which exchanges the into/use elements
+         *  \return The statement ready for the execution
+         */
+        template <class Binder>
+        statement_type& prepare(soci::session& session, std::string_view sql, Binder&& binder)
+        {
+            if (auto it = m_index.find(sql); it != m_index.end()) {
+                ++m_hits;
+                m_entries.splice(m_entries.begin(), m_entries, it->second);
+
+                statement_type& statement = it->second->second;
+                try {
+                    statement.bind_clean_up();
+                    std::forward<Binder>(binder)(statement);
+                    statement.define_and_bind();
+                } catch (...) {
+                    erase(it);
+                    throw;
+                }
+                return statement;
+            }
+
+            ++m_misses;
+
+            statement_type statement(session);
+            std::forward<Binder>(binder)(statement);
+            statement.alloc();
+            std::string text { sql };
+            statement.prepare(text);
+            statement.define_and_bind();
+
+            m_entries.emplace_front(std::move(text), std::move(statement));
+            m_index.emplace(m_entries.front().first, m_entries.begin());
+
+            while (m_entries.size() > m_capacity) {
+                erase(m_index.find(m_entries.back().first));
+            }
+
+            return m_entries.front().second;
+        }
+
+        /*! \fn void capacity(size_t capacity)
+         *  \brief Sets the maximum number of the statements held, evicts the exceeding ones
+         */
+        void capacity(size_t capacity)
+        {
+            assert(capacity > 0);
+            m_capacity = capacity;
+            while (m_entries.size() > m_capacity) {
+                erase(m_index.find(m_entries.back().first));
+            }
+        }
+
+        size_t capacity() const
+        {
+            return m_capacity;
+        }
+
+        size_t size() const
+        {
+            return m_entries.size();
+        }
+
+        size_t hits() const
+        {
+            return m_hits;
+        }
+
+        size_t misses() const
+        {
+            return m_misses;
+        }
+
+        void clear()
+        {
+            m_index.clear();
+            m_entries.clear();
+        }
+
+        /*! \fn void erase(std::string_view sql)
+         *  \brief Drops the statement of the \a sql if cached, e.g. one left in the middle of its results
+         */
+        void erase(std::string_view sql)
+        {
+            if (auto it = m_index.find(sql); it != m_index.end())
+                erase(it);
+        }
+
+    private:
+        using entry_type = std::pair<std::string, statement_type>;
+
+        using entries_type = std::list<entry_type>;
+
+        using index_type = std::unordered_map<std::string_view, typename entries_type::iterator>;
+
+        void erase(typename index_type::iterator it)
+        {
+            auto entry = it->second;
+            m_index.erase(it);
+            m_entries.erase(entry);
+        }
+
+        entries_type m_entries;
+        index_type m_index;
+        size_t m_capacity;
+        size_t m_hits;
+        size_t m_misses;
+    };
+
+} // namespace base
+} // namespace soci_wrapper
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace soci_wrapper {
+namespace base {
+
+    /*! \brief An append-only storage of the strings
+     *
+     *  The characters are copied into the blocks of block_size bytes allocated one after another, thus storing
+     *  a string is a copy and rarely an allocation; a string longer than a block gets a block of its own.
+     *  The views returned stay valid while the arena lives, moving the arena included; nothing is freed one by one.
+     */
+    class string_arena {
+    public:
+        static constexpr std::size_t default_block_size = 64 * 1024;
+
+        explicit string_arena(std::size_t block_size = default_block_size)
+            : m_blocks()
+            , m_block_size(std::max<std::size_t>(block_size, 1))
+            , m_position(nullptr)
+            , m_available(0)
+            , m_used(0)
+        {
+        }
+
+        string_arena(string_arena&&) = default;
+
+        string_arena& operator=(string_arena&&) = default;
+
+        string_arena(const string_arena&) = delete;
+
+        string_arena& operator=(const string_arena&) = delete;
+
+        /*! \fn std::string_view store(std::string_view value)
+         *  \brief Copies the \a value into the arena
+         *  \return A view of the copy
+         */
+        std::string_view store(std::string_view value)
+        {
+            if (value.empty())
+                return {};
+
+            if (value.size() > m_available) {
+                if (value.size() > m_block_size / 2) {
+                    // A large string does not waste the rest of the current block
+                    m_blocks.push_back(std::make_unique_for_overwrite<char[]>(value.size()));
+                    m_used += value.size();
+                    std::memcpy(m_blocks.back().get(), value.data(), value.size());
+                    return { m_blocks.back().get(), value.size() };
+                }
+
+                m_blocks.push_back(std::make_unique_for_overwrite<char[]>(m_block_size));
+                m_position = m_blocks.back().get();
+                m_available = m_block_size;
+            }
+
+            char* const data = m_position;
+            std::memcpy(data, value.data(), value.size());
+            m_position += value.size();
+            m_available -= value.size();
+            m_used += value.size();
+            return { data, value.size() };
+        }
+
+        /*! \fn std::size_t used() const
+         *  \brief Returns the number of the characters stored
+         */
+        std::size_t used() const
+        {
+            return m_used;
+        }
+
+        std::size_t blocks() const
+        {
+            return m_blocks.size();
+        }
+
+    private:
+        std::vector<std::unique_ptr<char[]>> m_blocks;
+        std::size_t m_block_size;
+        char* m_position;
+        std::size_t m_available;
+        std::size_t m_used;
+    };
+
+} // namespace base
+} // namespace soci_wrapper
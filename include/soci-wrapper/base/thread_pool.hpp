@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace soci_wrapper {
+namespace base {
+
+    /*! \brief A fixed set of the worker threads executing the posted jobs with work stealing
+     *
+     *  Each worker has a queue of its own: a job posted by a worker is queued to the worker itself,
+     *  the jobs posted by other threads are spread over the queues round-robin. A worker takes the oldest
+     *  job of its queue; once it is empty, the worker steals the newest job of another queue.
+     *  The jobs queued at the destruction are executed before the workers are joined.
+     */
+    class thread_pool {
+    public:
+        using job_type = std::function<void()>;
+
+        /*! \fn explicit thread_pool(std::size_t threads)
+         *  \param threads The number of the workers, the number of the hardware threads if zero
+         */
+        explicit thread_pool(std::size_t threads = 0)
+            : m_queues()
+            , m_pending(0)
+            , m_next(0)
+            , m_steals(0)
+            , m_mutex()
+            , m_wakeup()
+            , m_workers()
+        {
+            if (threads == 0)
+                threads = std::max(1u, std::thread::hardware_concurrency());
+
+            m_queues.reserve(threads);
+            for (std::size_t idx = 0; idx < threads; ++idx) {
+                m_queues.push_back(std::make_unique<worker_queue>());
+            }
+
+            m_workers.reserve(threads);
+            for (std::size_t idx = 0; idx < threads; ++idx) {
+                m_workers.emplace_back([this, idx](std::stop_token stop) {
+                    run(idx, stop);
+                });
+            }
+        }
+
+        thread_pool(const thread_pool&) = delete;
+
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        ~thread_pool()
+        {
+            for (auto& worker : m_workers) {
+                worker.request_stop();
+            }
+            m_workers.clear();
+        }
+
+        /*! \fn void post(job_type job)
+         *  \brief Queues the \a job to be executed by a worker
+         */
+        void post(job_type job)
+        {
+            const std::size_t idx = t_pool == this
+                ? t_index
+                : m_next.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+            // Counted before it is queued, a worker taking the job at once must not wrap the counter
+            m_pending.fetch_add(1);
+            {
+                std::lock_guard lock(m_queues[idx]->mutex);
+                m_queues[idx]->jobs.push_back(std::move(job));
+            }
+
+            // Taking the lock orders the notification after the check of a worker going to sleep
+            {
+                std::lock_guard lock(m_mutex);
+            }
+            m_wakeup.notify_one();
+        }
+
+        std::size_t size() const
+        {
+            return m_workers.size();
+        }
+
+        /*! \fn std::size_t steals() const
+         *  \brief Returns the number of the jobs taken from the queues of other workers
+         */
+        std::size_t steals() const
+        {
+            return m_steals.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct worker_queue {
+            std::mutex mutex;
+            std::deque<job_type> jobs;
+        };
+
+        void run(std::size_t idx, std::stop_token stop)
+        {
+            t_pool = this;
+            t_index = idx;
+
+            for (;;) {
+                job_type job;
+                if (take(idx, job)) {
+                    m_pending.fetch_sub(1);
+                    job();
+                    continue;
+                }
+
+                std::unique_lock lock(m_mutex);
+                m_wakeup.wait(lock, stop, [this] {
+                    return m_pending.load() > 0;
+                });
+                if (m_pending.load() == 0)
+                    break;
+            }
+
+            t_pool = nullptr;
+        }
+
+        bool take(std::size_t idx, job_type& job)
+        {
+            {
+                worker_queue& own = *m_queues[idx];
+                std::lock_guard lock(own.mutex);
+                if (not own.jobs.empty()) {
+                    job = std::move(own.jobs.front());
+                    own.jobs.pop_front();
+                    return true;
+                }
+            }
+
+            for (std::size_t offset = 1; offset < m_queues.size(); ++offset) {
+                worker_queue& victim = *m_queues[(idx + offset) % m_queues.size()];
+                std::lock_guard lock(victim.mutex);
+                if (not victim.jobs.empty()) {
+                    job = std::move(victim.jobs.back());
+                    victim.jobs.pop_back();
+                    m_steals.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static inline thread_local const thread_pool* t_pool = nullptr;
+        static inline thread_local std::size_t t_index = 0;
+
+        std::vector<std::unique_ptr<worker_queue>> m_queues;
+        std::atomic<std::size_t> m_pending;
+        std::atomic<std::size_t> m_next;
+        std::atomic<std::size_t> m_steals;
+        std::mutex m_mutex;
+        std::condition_variable_any m_wakeup;
+        std::vector<std::jthread> m_workers;
+    };
+
+} // namespace base
+} // namespace soci_wrapper
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <string>
+
 #include <boost/algorithm/string/join.hpp>
 #include <boost/range/adaptors.hpp>
 #include <concepts>
@@ -44,5 +47,15 @@ namespace base {
         return boost::algorithm::join(cont, sep);
     }
 
+    template <class T, std::size_t N>
+    std::string join(const std::array<T, N>& cont, const std::string& sep = ",")
+    {
+        return boost::algorithm::join(
+            cont | boost::adaptors::transformed([](const auto& v) {
+                return std::string { v };
+            }),
+            sep);
+    }
+
 } // namespace base
 } // namespace soci_wrapper
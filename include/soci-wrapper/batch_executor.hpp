@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "async.hpp"
+#include "base/thread_pool.hpp"
+#include "dml.hpp"
+#include "dql.hpp"
+#include "sessions_pool.hpp"
+
+namespace soci_wrapper {
+
+/*! \brief An executor of a batch of independent jobs over the sessions of a pool
+ *
+ *  The jobs are collected by submit() (or by the query and DML helpers) and launched by execute():
+ *  as many runners as there are sessions in the pool (bounded by the workers) are posted to a work-stealing
+ *  thread pool; each runner borrows a session once and takes the next job of the batch until none is left.
+ *  Thus the session checkout is paid per runner, not per job, and the fan-out latency shrinks with the pool size.
+ *  The results are delivered by futures; run_all() collects them into a vector in the submission order.
+ *  The futures of the jobs which are not executed before the destruction of the batch get std::future_error.
+ *  A runner waits for a session up to the session timeout; once no runner has got one, the jobs left
+ *  fail with std::runtime_error, thus the futures complete even if the pool can not lend a session.
+ */
+template <class Session>
+class batch_executor {
+public:
+    using pool_ptr_type = typename sessions_pool<Session>::ptr_type;
+
+    using session_raw_type = typename Session::session_type;
+
+    using executor_type = base::thread_pool;
+
+    /*! \fn batch_executor(pool_ptr_type pool, executor_type& executor, std::chrono::milliseconds session_timeout)
+     *  \param pool The pool lending the sessions to the runners
+     *  \param executor The threads running the jobs, must outlive the executed batches
+     *  \param session_timeout The time a runner waits for a busy session
+     */
+    explicit batch_executor(pool_ptr_type pool, executor_type& executor = async::default_executor(),
+        std::chrono::milliseconds session_timeout = async::default_session_timeout)
+        : m_pool(std::move(pool))
+        , m_executor(executor)
+        , m_session_timeout(session_timeout)
+        , m_jobs()
+    {
+    }
+
+    batch_executor(const batch_executor&) = delete;
+
+    batch_executor& operator=(const batch_executor&) = delete;
+
+    /*! \fn auto submit(Job job)
+     *  \brief Adds the \a job called with a session to the batch
+     *  \return A future of the job result
+     */
+    template <class Job>
+    auto submit(Job job)
+    {
+        auto task = std::make_unique<batch_job<Job>>(std::move(job));
+        auto future = task->get_future();
+        m_jobs.push_back(std::move(task));
+        return future;
+    }
+
+    template <class Type>
+    std::future<std::vector<Type>> objects(query::from<Type> query)
+    {
+        return submit([query = std::move(query)](session_raw_type& session) mutable {
+            return query.objects(session);
+        });
+    }
+
+    template <class Type>
+    std::future<Type> object(query::from<Type> query)
+    {
+        return submit([query = std::move(query)](session_raw_type& session) mutable {
+            return query.object(session);
+        });
+    }
+
+    template <class Type>
+    std::future<int> count(query::from<Type> query)
+    {
+        return submit([query = std::move(query)](session_raw_type& session) mutable {
+            return query.count(session);
+        });
+    }
+
+    /*! \fn std::future<void> persist(Value value)
+     *  \brief Adds persisting of the \a value, either an object or a range of objects, to the batch
+     */
+    template <class Value>
+    std::future<void> persist(Value value)
+    {
+        return submit([value = std::move(value)](session_raw_type& session) {
+            dml::persist(session, value);
+        });
+    }
+
+    /*! \fn size_t size() const
+     *  \brief Returns the number of the jobs submitted since the last execute()
+     */
+    size_t size() const
+    {
+        return m_jobs.size();
+    }
+
+    /*! \fn void execute()
+     *  \brief Launches the submitted jobs, does not wait for them; the batch is empty afterwards
+     */
+    void execute()
+    {
+        if (m_jobs.empty())
+            return;
+
+        const size_t runners = std::clamp<size_t>(
+            std::min(m_pool->total(), m_executor.size()), 1, m_jobs.size());
+
+        auto state = std::make_shared<batch_state>(m_pool, std::move(m_jobs), runners, m_session_timeout);
+        m_jobs.clear();
+
+        for (size_t runner = 0; runner < runners; ++runner) {
+            m_executor.post([state] {
+                drain(*state);
+            });
+        }
+    }
+
+    /*! \fn static auto run_all(pool_ptr_type pool, Jobs&& jobs, executor_type& executor, std::chrono::milliseconds session_timeout)
+     *  \brief Executes the \a jobs and waits for them
+     *  \return The results in the order of the \a jobs; the first failure is rethrown once all the jobs are over
+     */
+    template <std::ranges::input_range Jobs>
+    static auto run_all(pool_ptr_type pool, Jobs&& jobs, executor_type& executor = async::default_executor(),
+        std::chrono::milliseconds session_timeout = async::default_session_timeout)
+    {
+        using job_type = std::ranges::range_value_t<Jobs>;
+        using result_type = std::invoke_result_t<job_type&, session_raw_type&>;
+
+        batch_executor batch(std::move(pool), executor, session_timeout);
+        std::vector<std::future<result_type>> futures;
+        for (auto&& job : jobs) {
+            futures.push_back(batch.submit(job_type { std::forward<decltype(job)>(job) }));
+        }
+        batch.execute();
+
+        for (auto& future : futures) {
+            future.wait();
+        }
+
+        if constexpr (std::is_void_v<result_type>) {
+            for (auto& future : futures) {
+                future.get();
+            }
+        } else {
+            std::vector<result_type> results;
+            results.reserve(futures.size());
+            for (auto& future : futures) {
+                results.push_back(future.get());
+            }
+            return results;
+        }
+    }
+
+private:
+    struct batch_job_base {
+        virtual ~batch_job_base() = default;
+
+        virtual void run(session_raw_type& session) = 0;
+
+        /*! \fn virtual void fail(std::exception_ptr error)
+         *  \brief Completes the future of a job which can not be run by the \a error
+         */
+        virtual void fail(std::exception_ptr error) = 0;
+    };
+
+    template <class Job>
+    class batch_job : public batch_job_base {
+    public:
+        using result_type = std::invoke_result_t<Job&, session_raw_type&>;
+
+        explicit batch_job(Job job)
+            : m_job(std::move(job))
+            , m_promise()
+        {
+        }
+
+        std::future<result_type> get_future()
+        {
+            return m_promise.get_future();
+        }
+
+        void run(session_raw_type& session) override
+        {
+            try {
+                if constexpr (std::is_void_v<result_type>) {
+                    std::invoke(m_job, session);
+                    m_promise.set_value();
+                } else {
+                    m_promise.set_value(std::invoke(m_job, session));
+                }
+            } catch (...) {
+                m_promise.set_exception(std::current_exception());
+            }
+        }
+
+        void fail(std::exception_ptr error) override
+        {
+            m_promise.set_exception(error);
+        }
+
+    private:
+        Job m_job;
+        std::promise<result_type> m_promise;
+    };
+
+    using batch_job_ptr_type = std::unique_ptr<batch_job_base>;
+
+    struct batch_state {
+        batch_state(pool_ptr_type pool, std::vector<batch_job_ptr_type> jobs, size_t runners, std::chrono::milliseconds timeout)
+            : pool(std::move(pool))
+            , jobs(std::move(jobs))
+            , next(0)
+            , runners(runners)
+            , session_timeout(timeout)
+        {
+        }
+
+        const pool_ptr_type pool;
+        const std::vector<batch_job_ptr_type> jobs;
+        std::atomic<size_t> next;
+        std::atomic<size_t> runners;
+        const std::chrono::milliseconds session_timeout;
+    };
+
+    /*! \fn static void drain(batch_state& state)
+     *  \brief A runner, takes the jobs of the batch one by one with a single session
+     *
+     *  A runner holding a session runs the jobs until none is left, thus the jobs are left only
+     *  if no runner has got a session; the last runner to exit fails them.
+     */
+    static void drain(batch_state& state)
+    {
+        if (auto session = state.pool->get_session(state.session_timeout)) {
+            for (size_t idx = state.next.fetch_add(1); idx < state.jobs.size(); idx = state.next.fetch_add(1)) {
+                state.jobs[idx]->run(static_cast<session_raw_type&>(*session));
+            }
+        }
+
+        if (state.runners.fetch_sub(1) != 1)
+            return;
+
+        for (size_t idx = state.next.fetch_add(1); idx < state.jobs.size(); idx = state.next.fetch_add(1)) {
+            state.jobs[idx]->fail(std::make_exception_ptr(std::runtime_error("No session of the pool is available")));
+        }
+    }
+
+    pool_ptr_type m_pool;
+    executor_type& m_executor;
+    const std::chrono::milliseconds m_session_timeout;
+    std::vector<batch_job_ptr_type> m_jobs;
+};
+
+} // namespace soci_wrapper
@@ -17,6 +17,8 @@ public:
 
     using foreign_key_container_type = typename config::configuration_attributes<Type>::foreign_key_container_type;
 
+    using flags_type = typename config::configuration_attributes<Type>::flags_type;
+
     static_assert(details::type_meta_data<Type>::is_declared::value,
         "The concerned Type is not declared as a persistent type");
 
@@ -43,11 +45,27 @@ public:
         return config::configuration_attributes<Type>::primary_key();
     }
 
+    /*! \fn static const flags_type& primary_key_flags()
+     *  \brief The primary key constraints indexed by the declaration order of the members
+     */
+    static const flags_type& primary_key_flags()
+    {
+        return config::configuration_attributes<Type>::primary_key_flags();
+    }
+
     static const container_type& auto_increment()
     {
         return config::configuration_attributes<Type>::auto_increment();
     }
 
+    /*! \fn static const flags_type& auto_increment_flags()
+     *  \brief The auto increment constraints indexed by the declaration order of the members
+     */
+    static const flags_type& auto_increment_flags()
+    {
+        return config::configuration_attributes<Type>::auto_increment_flags();
+    }
+
     static const foreign_key_container_type& foreign_key()
     {
         return config::configuration_attributes<Type>::foreign_key();
@@ -24,27 +24,19 @@ struct ddl {
 
     static void drop_table(session::session_type& session)
     {
-        std::stringstream sql;
-        sql << "DROP TABLE IF EXISTS "
-            << self_type::type_meta_data::table_name();
-        session << sql.str();
+        session << details::sql_text<Type>::drop;
     }
 
     static void create_table(session::session_type& session)
     {
-        assert(self_type::type_meta_data::fields_number::value == self_type::type_meta_data::member_names().size());
+        static_assert(self_type::type_meta_data::fields_number::value == self_type::type_meta_data::member_names().size());
 
         std::stringstream sql;
-        sql << "CREATE TABLE IF NOT EXISTS "
-            << self_type::type_meta_data::table_name()
-            << " (";
+        sql << details::sql_text<Type>::create;
 
-        std::vector<std::string> fields;
-        base::tuple_for_each(
-            self_type::type_meta_data::types_pair(),
-            format_fields(fields));
-
-        sql << base::join(fields);
+        for (size_t idx = 0; idx < self_type::type_meta_data::fields_number::value; ++idx) {
+            sql << (idx ? "," : "") << format_field(idx);
+        }
 
         for (const auto& v : self_type::configuration_type::foreign_key()) {
             sql << ", FOREIGN KEY (" << v.first << ")"
@@ -72,45 +64,34 @@ struct ddl {
     }
 
 private:
-    struct format_fields {
-        format_fields(std::vector<std::string>& vec)
-            : m_vec(vec)
-        {
-        }
+    static std::string format_field(size_t idx)
+    {
+        const std::string name { self_type::type_meta_data::member_names()[idx] };
 
-        template <class T>
-        void operator()(const T& val)
-        {
-            using cpp_type = std::remove_reference_t<std::remove_pointer_t<decltype(val.first)>>;
+        std::stringstream str;
+        str << name << " " << details::db_types<Type>::value[idx];
 
-            std::stringstream str;
-            str << val.second << " " << cpp_to_db_type<cpp_type>::db_type;
+        // process NOT NULL
+        if (self_type::configuration_type::not_null().contains(name)) {
+            str << " NOT NULL";
+        }
 
-            // process NOT NULL
-            if (self_type::configuration_type::not_null().contains(val.second)) {
-                str << " NOT NULL";
-            }
+        // process UNIQUE
+        if (self_type::configuration_type::unique().contains(name)) {
+            str << " UNIQUE";
+        }
 
-            // process UNIQUE
-            if (self_type::configuration_type::unique().contains(val.second)) {
-                str << " UNIQUE";
+        // process AUTOINCREMENT
+        if (self_type::configuration_type::auto_increment().contains(name)) {
+            str << " PRIMARY KEY AUTOINCREMENT";
+        } else
+            // process PRIMARY KEY
+            if (self_type::configuration_type::primary_key().contains(name)) {
+                str << " PRIMARY KEY";
             }
 
-            // process AUTOINCREMENT
-            if (self_type::configuration_type::auto_increment().contains(val.second)) {
-                str << " PRIMARY KEY AUTOINCREMENT";
-            } else
-                // process PRIMARY KEY
-                if (self_type::configuration_type::primary_key().contains(val.second)) {
-                    str << " PRIMARY KEY";
-                }
-
-            m_vec.emplace_back(str.str());
-        }
-
-    private:
-        std::vector<std::string>& m_vec;
-    };
+        return str.str();
+    }
 };
 
 template <class Type>
@@ -1,14 +1,82 @@
 #pragma once
 
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <ranges>
+
 #include "base/utility.hpp"
 #include "session.hpp"
 #include "types_convertor.hpp"
 
+#ifndef SW_SQLITE_MAX_VARIABLE_NUMBER
+// The SQLite default limit of the host parameters prior to 3.32.0
+#define SW_SQLITE_MAX_VARIABLE_NUMBER 999
+#endif
+
 namespace soci_wrapper {
+namespace details {
+
+    /*! \brief RAII savepoint
+     *
+     *  Opens a transaction when there is none or nests into the running one.
+     *  The changes are rolled back unless release() is called.
+     */
+    class savepoint {
+    public:
+        savepoint(session::session_type& session)
+            : m_session(session)
+            , m_released(false)
+        {
+            m_session << "SAVEPOINT sw_savepoint";
+        }
+
+        savepoint(const savepoint&) = delete;
+
+        savepoint& operator=(const savepoint&) = delete;
+
+        ~savepoint()
+        {
+            if (m_released)
+                return;
+
+            try {
+                m_session << "ROLLBACK TO sw_savepoint";
+                m_session << "RELEASE sw_savepoint";
+            } catch (...) {
+            }
+        }
+
+        void release()
+        {
+            m_session << "RELEASE sw_savepoint";
+            m_released = true;
+        }
+
+    private:
+        session::session_type& m_session;
+        bool m_released;
+    };
+
+} // namespace details
 
 /*! \brief DML -- Data Modification Language
  */
 struct dml {
+    /*! \brief The default number of rows sent to DB by a single execution of persist_bulk()
+     */
+    static constexpr std::size_t bulk_chunk_size = 1000;
+
+    /*! \brief The maximum number of the host parameters in a single statement
+     */
+    static constexpr std::size_t max_variable_number = SW_SQLITE_MAX_VARIABLE_NUMBER;
+
+    /*! \brief The number of rows inserted by a single multi-row INSERT of the \a Type
+     */
+    template <class Type>
+    static constexpr std::size_t values_chunk_size = std::max<std::size_t>(
+        1, max_variable_number / details::type_meta_data<Type>::fields_number::value);
+
     template <class... Type>
     static void persist(session::session_type& session, Type&&... objects)
     {
@@ -17,7 +85,245 @@ struct dml {
             handle(session));
     }
 
+    /*! \fn static void persist(session::session_type& session, Range&& objects)
+     *  \brief Persists a range of \a objects by multi-row INSERT INTO ... VALUES (...),(...) statements
+     *
+     *  The rows are sent by chunks of values_chunk_size<Type> to keep the number of the bound parameters
+     *  under max_variable_number. The whole range is stored atomically.
+     *  \param session The session to be used
+     *  \param objects A range of objects of the same persistent type
+     */
+    template <std::ranges::input_range Range>
+        requires details::type_meta_data<std::ranges::range_value_t<Range>>::is_declared::value
+    static void persist(session::session_type& session, Range&& objects)
+    {
+        using object_type = std::ranges::range_value_t<Range>;
+
+        constexpr std::size_t chunk_size = values_chunk_size<object_type>;
+
+        details::column_buffers<object_type> buffers;
+        buffers.reserve(chunk_size);
+
+        details::savepoint savepoint(session);
+        for (const object_type& object : objects) {
+            buffers.push_back(object);
+            if (buffers.size() == chunk_size) {
+                static const std::string sql = values_sql<object_type>(chunk_size);
+                session.statements().prepare(session, sql,
+                                        [&buffers](soci::statement& st) {
+                                            buffers.bind_rows(st);
+                                        })
+                    .execute(true);
+                buffers.clear();
+            }
+        }
+
+        if (buffers.size()) {
+            // The tail is not cached, its size varies from call to call
+            soci::statement statement(session);
+            buffers.bind_rows(statement);
+            statement.alloc();
+            statement.prepare(values_sql<object_type>(buffers.size()));
+            statement.define_and_bind();
+            statement.execute(true);
+        }
+        savepoint.release();
+    }
+
+    /*! \fn static void persist_bulk(session::session_type& session, Range&& objects, std::size_t chunk_size)
+     *  \brief Persists a range of \a objects by binding them column-wise as vectors
+     *
+     *  The INSERT statement is prepared once and executed per chunk of \a chunk_size rows;
+     *  the column buffers are reused between the chunks. The whole range is stored atomically.
+     *  \param session The session to be used
+     *  \param objects A range of objects of the same persistent type
+     *  \param chunk_size The number of rows bound per a single execution
+     */
+    template <std::ranges::input_range Range>
+    static void persist_bulk(session::session_type& session, Range&& objects, std::size_t chunk_size = bulk_chunk_size)
+    {
+        using object_type = std::ranges::range_value_t<Range>;
+        using type_meta_data = details::type_meta_data<object_type>;
+
+        static_assert(type_meta_data::is_declared::value,
+            "The objects being persisted were not declared");
+
+        assert(chunk_size > 0);
+
+        details::column_buffers<object_type> buffers;
+        buffers.reserve(chunk_size);
+
+        soci::statement statement(session);
+        buffers.bind(statement);
+        statement.alloc();
+        statement.prepare(std::string { details::sql_text<object_type>::insert });
+        statement.define_and_bind();
+
+        details::savepoint savepoint(session);
+        for (const object_type& object : objects) {
+            buffers.push_back(object);
+            if (buffers.size() == chunk_size) {
+                statement.execute(true);
+                buffers.clear();
+            }
+        }
+
+        if (buffers.size()) {
+            statement.execute(true);
+        }
+        savepoint.release();
+    }
+
+    /*! \brief A policy of grouping the writes of batch_writer into transactions
+     */
+    struct batch_policy {
+        std::size_t rows = 1000;
+        std::chrono::milliseconds interval = std::chrono::milliseconds { 1000 };
+    };
+
+    /*! \brief A writer batching persist() calls into transactions
+     *
+     *  A transaction is opened by the first write and committed once \a rows objects are written
+     *  or the \a interval has elapsed since the first write; the policy is checked on each write and by poll().
+     *  The writer runs no timer of its own since the session belongs to the caller's thread: an idle writer
+     *  keeps its transaction, and the database write lock, open until the next write, poll(), flush()
+     *  or its destruction. A failed write rolls the whole pending batch back and rethrows.
+     *  The errors of the commit on destruction are swallowed, call flush() to observe them.
+     */
+    template <class Type>
+    class batch_writer {
+    public:
+        using self_type = batch_writer<Type>;
+
+        using object_type = Type;
+
+        using clock_type = std::chrono::steady_clock;
+
+        static_assert(details::type_meta_data<Type>::is_declared::value,
+            "The object being persisted was not declared");
+
+        /*! \fn batch_writer(session_handle session, batch_policy policy)
+         *  \param session A session or an rvalue session_proxy which is kept by the writer
+         *  \param policy The policy of the commits
+         */
+        explicit batch_writer(session_handle session, batch_policy policy = {})
+            : m_session(std::move(session))
+            , m_policy(policy)
+            , m_savepoint {}
+            , m_pending(0)
+            , m_started {}
+        {
+            assert(m_policy.rows > 0);
+        }
+
+        batch_writer(const batch_writer&) = delete;
+
+        batch_writer& operator=(const batch_writer&) = delete;
+
+        ~batch_writer()
+        {
+            try {
+                flush();
+            } catch (...) {
+            }
+        }
+
+        void persist(const Type& object)
+        {
+            if (not m_savepoint) {
+                m_savepoint.emplace(m_session.get());
+                m_started = clock_type::now();
+            }
+
+            try {
+                handle(m_session.get())(object);
+            } catch (...) {
+                rollback();
+                throw;
+            }
+
+            ++m_pending;
+            if (m_pending >= m_policy.rows or due()) {
+                flush();
+            }
+        }
+
+        /*! \fn bool poll()
+         *  \brief Commits the pending batch if its interval has elapsed, e.g. from an idle loop of the writing thread
+         *  \return true if a batch has been committed
+         */
+        bool poll()
+        {
+            if (not m_savepoint or not due())
+                return false;
+
+            flush();
+            return true;
+        }
+
+        /*! \fn void flush()
+         *  \brief Commits the pending batch
+         */
+        void flush()
+        {
+            if (not m_savepoint)
+                return;
+
+            m_pending = 0;
+            try {
+                m_savepoint->release();
+            } catch (...) {
+                m_savepoint.reset();
+                throw;
+            }
+            m_savepoint.reset();
+        }
+
+        /*! \fn void rollback()
+         *  \brief Discards the pending batch
+         */
+        void rollback()
+        {
+            m_pending = 0;
+            m_savepoint.reset();
+        }
+
+        std::size_t pending() const
+        {
+            return m_pending;
+        }
+
+    private:
+        bool due() const
+        {
+            return clock_type::now() - m_started >= m_policy.interval;
+        }
+
+        session_handle m_session;
+        const batch_policy m_policy;
+        std::optional<details::savepoint> m_savepoint;
+        std::size_t m_pending;
+        clock_type::time_point m_started;
+    };
+
 private:
+    template <class Type>
+    static std::string values_sql(std::size_t rows)
+    {
+        constexpr std::size_t fields = details::type_meta_data<Type>::fields_number::value;
+
+        std::string sql { details::sql_text<Type>::insert_values };
+        for (std::size_t row = 0; row < rows; ++row) {
+            sql += row ? ",(" : "(";
+            for (std::size_t field = 0; field < fields; ++field) {
+                sql += field ? ",:p" : ":p";
+                sql += std::to_string(row * fields + field);
+            }
+            sql += ")";
+        }
+        return sql;
+    }
+
     struct handle {
         handle(session::session_type& session)
             : sql_session(session)
@@ -40,25 +346,11 @@ private:
             static_assert(type_meta_data::is_declared::value,
                 "The object being persisted was not declared");
 
-            auto fields = type_meta_data::member_names();
-            std::vector<std::string> sql_placeholders { fields.size() };
-
-            std::transform(std::begin(fields), std::end(fields),
-                std::begin(sql_placeholders),
-                [](auto field) {
-                    std::stringstream str;
-                    str << ":" << field;
-                    return str.str();
+            auto& statement = sql_session.statements().prepare(sql_session, details::sql_text<decayed_type>::insert,
+                [&object](soci::statement& st) {
+                    st.exchange(soci::use(object));
                 });
-
-            std::stringstream sql;
-            sql << "INSERT INTO " << type_meta_data::table_name() << " ("
-                << base::join(fields)
-                << ") VALUES ("
-                << base::join(sql_placeholders)
-                << ")";
-
-            sql_session << sql.str(), soci::use(std::forward<Type>(object));
+            statement.execute(true);
         }
 
         session::session_type& sql_session;
@@ -1,9 +1,14 @@
 #pragma once
 
+#include <cassert>
 #include <concepts>
 #include <iterator>
+#include <memory>
 #include <sstream>
+#include <stdexcept>
+#include <variant>
 
+#include "base/string_arena.hpp"
 #include "base/terminals.hpp"
 #include "base/utility.hpp"
 #include "session.hpp"
@@ -44,6 +49,58 @@ namespace query {
                                logical_and> {
     };
 
+    /*! \brief The literals of a query bound as the :pN placeholders
+     *
+     *  The values are kept out of the SQL text, thus the queries differing by the values only
+     *  share the same prepared statement.
+     */
+    class bindings {
+    public:
+        using value_type = std::variant<int, std::string>;
+
+        bindings()
+            : m_values {}
+        {
+        }
+
+        /*! \fn std::string add(value_type value)
+         *  \brief Stores the \a value to be bound
+         *  \return The placeholder to be used in the SQL text
+         */
+        std::string add(value_type value)
+        {
+            std::string placeholder = ":p" + std::to_string(m_values.size());
+            m_values.emplace_back(std::move(value));
+            return placeholder;
+        }
+
+        /*! \fn void set(size_t idx, value_type value)
+         *  \brief Replaces the \a idx-th value stored, e.g. the key of the next page
+         */
+        void set(size_t idx, value_type value)
+        {
+            m_values.at(idx) = std::move(value);
+        }
+
+        void bind(soci::statement& statement)
+        {
+            for (size_t idx = 0; idx < m_values.size(); ++idx) {
+                std::visit([&statement, idx](auto& value) {
+                    statement.exchange(soci::use(value, "p" + std::to_string(idx)));
+                },
+                    m_values[idx]);
+            }
+        }
+
+        size_t size() const
+        {
+            return m_values.size();
+        }
+
+    private:
+        std::vector<value_type> m_values;
+    };
+
     template <class Type>
     struct context : boost::proto::callable_context<const context<Type>> {
         using self_type = context<Type>;
@@ -52,6 +109,11 @@ namespace query {
 
         using type_meta_data = details::type_meta_data<Type>;
 
+        explicit context(query::bindings& bindings)
+            : m_bindings(bindings)
+        {
+        }
+
         template <placeholder::index_type Idx>
         result_type operator()(boost::proto::tag::terminal, placeholder::query_placeholder<Idx>) const
         {
@@ -60,14 +122,12 @@ namespace query {
 
         result_type operator()(boost::proto::tag::terminal, int i) const
         {
-            return std::to_string(i);
+            return m_bindings.add(i);
         }
 
         result_type operator()(boost::proto::tag::terminal, base::type_in<std::string, std::string_view> auto&& val) const
         {
-            std::stringstream str;
-            str << "'" << val << "'";
-            return str.str();
+            return m_bindings.add(std::string { val });
         }
 
         template <class Op, class Left, class Right>
@@ -90,6 +150,345 @@ namespace query {
             }
             return (str << boost::proto::eval(right, *this), str.str());
         }
+
+    private:
+        query::bindings& m_bindings;
+    };
+
+    /*! \brief A chunk of the query results held column-wise
+     *
+     *  std::get<Idx>(chunk.columns) is the vector of the values of the Idx-th declared member,
+     *  chunk.indicators[Idx] tells the NULLs apart; chunk.size() is the number of the rows.
+     */
+    template <class Type>
+    using column_chunk = details::column_buffers<Type>;
+
+    template <class Value>
+    using column_value_t = std::conditional_t<std::is_same_v<Value, std::string> or details::treat_as_array_v<Value>,
+        std::string_view, Value>;
+
+    template <class Tuple>
+    struct column_vectors_of;
+
+    template <class... Values>
+    struct column_vectors_of<std::tuple<Values...>> {
+        using type = std::tuple<std::vector<column_value_t<Values>>...>;
+    };
+
+    /*! \brief A struct-of-arrays container of the query results
+     *
+     *  Holds a contiguous vector per declared member, a column is accessed by the DSL field,
+     *  e.g. rows[fields_query<Type>::value], or by the index. The strings and the char arrays are kept
+     *  as std::string_view into an arena owned by the container. NULLs are read as the default values.
+     */
+    template <class Type>
+    class columns {
+    public:
+        using self_type = columns<Type>;
+
+        using object_type = Type;
+
+        using type_meta_data = details::type_meta_data<Type>;
+
+        using tuple_type = typename type_meta_data::tuple_type;
+
+        using fields_number = typename type_meta_data::fields_number;
+
+        using vectors_type = typename column_vectors_of<tuple_type>::type;
+
+        columns()
+            : m_columns {}
+            , m_strings {}
+        {
+        }
+
+        columns(columns&&) = default;
+
+        columns& operator=(columns&&) = default;
+
+        /*! \fn const auto& operator[](const Field& field) const
+         *  \brief Returns the column of the DSL \a field, e.g. fields_query<Type>::id
+         */
+        template <class Field>
+        const auto& operator[](const Field&) const
+        {
+            return get<Field::proto_args::child0::value>();
+        }
+
+        template <size_t Idx>
+        const auto& get() const
+        {
+            return std::get<Idx>(m_columns);
+        }
+
+        size_t size() const
+        {
+            return std::get<0>(m_columns).size();
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        void reserve(size_t size)
+        {
+            std::apply([size](auto&... column) {
+                (column.reserve(size), ...);
+            },
+                m_columns);
+        }
+
+        /*! \fn Type object(size_t row) const
+         *  \brief Builds the object of the \a row
+         */
+        Type object(size_t row) const
+        {
+            Type ret {};
+            object(row, ret, std::make_index_sequence<fields_number::value> {});
+            return ret;
+        }
+
+        /*! \fn void append(column_chunk<Type>& chunk)
+         *  \brief Appends the rows of the \a chunk, the values are moved out of it
+         */
+        void append(column_chunk<Type>& chunk)
+        {
+            append(chunk, std::make_index_sequence<fields_number::value> {});
+        }
+
+        /*! \fn const base::string_arena& strings() const
+         *  \brief Returns the storage of the string values
+         */
+        const base::string_arena& strings() const
+        {
+            return m_strings;
+        }
+
+    private:
+        template <size_t... Idx>
+        void append(column_chunk<Type>& chunk, std::index_sequence<Idx...>)
+        {
+            (append_column<Idx>(chunk), ...);
+        }
+
+        template <size_t Idx>
+        void append_column(column_chunk<Type>& chunk)
+        {
+            using cpp_type = std::tuple_element_t<Idx, tuple_type>;
+
+            auto& column = std::get<Idx>(m_columns);
+            auto& src = std::get<Idx>(chunk.columns);
+            const auto& indicators = chunk.indicators[Idx];
+            for (size_t row = 0; row < chunk.size(); ++row) {
+                const bool null = indicators[row] == soci::i_null;
+                if constexpr (std::is_same_v<column_value_t<cpp_type>, std::string_view>) {
+                    std::string_view value = null ? std::string_view {} : std::string_view { src[row] };
+                    if constexpr (details::treat_as_array_v<cpp_type>)
+                        value = value.substr(0, std::min(value.find('\0'), std::size(cpp_type {})));
+                    column.push_back(m_strings.store(value));
+                } else {
+                    column.push_back(null ? cpp_type {} : std::move(src[row]));
+                }
+            }
+        }
+
+        template <size_t... Idx>
+        void object(size_t row, Type& object, std::index_sequence<Idx...>) const
+        {
+            (object_field<Idx>(row, object), ...);
+        }
+
+        template <size_t Idx>
+        void object_field(size_t row, Type& object) const
+        {
+            using cpp_type = std::tuple_element_t<Idx, tuple_type>;
+
+            auto& value = details::member_at<Idx>(object);
+            const auto& src = std::get<Idx>(m_columns)[row];
+            if constexpr (details::treat_as_array_v<cpp_type>) {
+                std::fill(std::begin(value), std::end(value), '\0');
+                std::copy_n(src.begin(), std::min(src.size(), std::size(value)), std::begin(value));
+            } else {
+                value = cpp_type { src };
+            }
+        }
+
+        vectors_type m_columns;
+        base::string_arena m_strings;
+    };
+
+    /*! \brief A streaming cursor over the query results
+     *
+     *  An input range yielding the objects one by one. The rows are fetched by batches into the column vectors,
+     *  thus the memory used is bounded by the batch size regardless the size of the result set.
+     *  The cursor keeps the session handle for its lifetime.
+     */
+    template <class Type>
+    class cursor {
+    private:
+        struct state {
+            state(session::session_type& session, const std::string& sql, const query::bindings& binds, std::size_t size)
+                : statement(session)
+                , columns {}
+                , bindings(binds)
+                , batch {}
+                , batch_size(size)
+                , pos(0)
+                , exhausted(false)
+            {
+                assert(batch_size > 0);
+
+                columns.resize(batch_size);
+                columns.bind_into(statement);
+                bindings.bind(statement);
+                statement.alloc();
+                statement.prepare(sql);
+                statement.define_and_bind();
+                statement.execute();
+
+                batch.reserve(batch_size);
+            }
+
+            bool fill()
+            {
+                batch.clear();
+                pos = 0;
+                if (exhausted)
+                    return false;
+
+                // A single fetch brings the whole batch into the column vectors
+                columns.resize(batch_size);
+                if (statement.fetch()) {
+                    batch.resize(columns.size());
+                    for (std::size_t row = 0; row < batch.size(); ++row) {
+                        columns.move_to(row, batch[row]);
+                    }
+                }
+                exhausted = batch.size() < batch_size;
+                return not batch.empty();
+            }
+
+            bool next()
+            {
+                return ++pos < batch.size() or fill();
+            }
+
+            soci::statement statement;
+            details::column_buffers<Type> columns;
+            query::bindings bindings;
+            std::vector<Type> batch;
+            const std::size_t batch_size;
+            std::size_t pos;
+            bool exhausted;
+        };
+
+    public:
+        using self_type = cursor<Type>;
+
+        using object_type = Type;
+
+        static constexpr std::size_t default_batch_size = 256;
+
+        class iterator {
+        public:
+            using iterator_concept = std::input_iterator_tag;
+
+            using iterator_category = std::input_iterator_tag;
+
+            using value_type = Type;
+
+            using difference_type = std::ptrdiff_t;
+
+            using reference = Type&;
+
+            using pointer = Type*;
+
+            iterator()
+                : m_state(nullptr)
+            {
+            }
+
+            reference operator*() const
+            {
+                return m_state->batch[m_state->pos];
+            }
+
+            pointer operator->() const
+            {
+                return &m_state->batch[m_state->pos];
+            }
+
+            iterator& operator++()
+            {
+                if (not m_state->next())
+                    m_state = nullptr;
+                return *this;
+            }
+
+            void operator++(int)
+            {
+                ++*this;
+            }
+
+            friend bool operator==(const iterator& it, std::default_sentinel_t)
+            {
+                return it.m_state == nullptr;
+            }
+
+        private:
+            friend self_type;
+
+            explicit iterator(state* st)
+                : m_state(st)
+            {
+            }
+
+            state* m_state;
+        };
+
+        cursor(session_handle session, const std::string& sql, const query::bindings& bindings, std::size_t batch_size)
+            : m_session(std::move(session))
+            , m_state(std::make_unique<state>(m_session.get(), sql, bindings, batch_size))
+            , m_started(false)
+        {
+        }
+
+        cursor(cursor&&) = default;
+
+        /*! \fn cursor& operator=(cursor&& rhs)
+         *  \brief Releases the current state before the session its statement runs on
+         */
+        cursor& operator=(cursor&& rhs) noexcept
+        {
+            m_state = std::move(rhs.m_state);
+            m_session = std::move(rhs.m_session);
+            m_started = rhs.m_started;
+            return *this;
+        }
+
+        /*! \fn iterator begin()
+         *  \brief Returns an iterator to the current row; the first call fetches the first batch
+         */
+        iterator begin()
+        {
+            if (not m_started) {
+                m_started = true;
+                if (not m_state->fill())
+                    return iterator {};
+            }
+            return m_state->pos < m_state->batch.size() ? iterator { m_state.get() } : iterator {};
+        }
+
+        std::default_sentinel_t end() const
+        {
+            return std::default_sentinel;
+        }
+
+    private:
+        session_handle m_session;
+        std::unique_ptr<state> m_state;
+        bool m_started;
     };
 
     struct all_fields_tag {
@@ -98,6 +497,19 @@ namespace query {
     struct count_tag {
     };
 
+    struct first_row_tag {
+    };
+
+    template <size_t... Idx>
+    struct fields_tag {
+    };
+
+    template <class Type, size_t... Idx>
+    class projection;
+
+    template <class Type, size_t Key>
+    class pager;
+
     template <class Type>
     class from {
     private:
@@ -137,57 +549,153 @@ namespace query {
 
         using type_meta_data = details::type_meta_data<Type>;
 
+        /*! \brief The default number of the rows fetched at once by objects() and for_each_chunk()
+         */
+        static constexpr std::size_t default_fetch_size = 256;
+
         static_assert(type_meta_data::is_declared::value,
             "The concerned Type is not declared as a persistent type");
         static_assert(std::is_default_constructible_v<Type>,
             "The concerned Type is not default constructible");
 
         from()
-            : m_sql_stream {}
+            : m_sql {}
+            , m_bindings {}
             , m_order_by {}
             , m_limit { std::nullopt }
+            , m_seek { std::nullopt }
         {
         }
 
         template <class Expr>
         self_type& where(const Expr& expr)
         {
-            m_sql_stream << " WHERE " << eval(expr);
+            m_sql += " WHERE " + eval(expr);
             return *this;
         }
 
         template <class Expr>
         self_type& conjunction(const Expr& expr)
         {
-            m_sql_stream << " AND " << eval(expr);
+            m_sql += " AND " + eval(expr);
             return *this;
         }
 
         template <class Expr>
         self_type& disjunction(const Expr& expr)
         {
-            m_sql_stream << " OR " << eval(expr);
+            m_sql += " OR " + eval(expr);
             return *this;
         }
 
+        /*! \fn Cont<Type, Args...> objects(session::session_type& session, std::size_t fetch_size)
+         *  \brief Executes the query and returns all the selected objects
+         *  \param session The session to be used
+         *  \param fetch_size The number of the rows fetched at once into the column vectors
+         */
         template <template <class...> class Cont = std::vector, class... Args>
-        Cont<Type, Args...> objects(session::session_type& session)
+        Cont<Type, Args...> objects(session::session_type& session, std::size_t fetch_size = default_fetch_size)
         {
-            soci::rowset<Type> rs = (session.prepare << sql_builder(all_fields_tag {}));
-            return Cont<Type, Args...> { std::make_move_iterator(rs.begin()), std::make_move_iterator(rs.end()) };
+            Cont<Type, Args...> ret {};
+            for_each_chunk(session, [&ret](column_chunk<Type>& chunk) {
+                for (std::size_t row = 0; row < chunk.size(); ++row) {
+                    Type object {};
+                    chunk.move_to(row, object);
+                    ret.insert(ret.end(), std::move(object));
+                }
+            }, fetch_size);
+            return ret;
+        }
+
+        /*! \fn query::columns<Type> columns(session::session_type& session, std::size_t fetch_size)
+         *  \brief Executes the query and returns the results column-wise, see query::columns
+         *  \param session The session to be used
+         *  \param fetch_size The number of the rows fetched at once
+         */
+        query::columns<Type> columns(session::session_type& session, std::size_t fetch_size = default_fetch_size)
+        {
+            query::columns<Type> ret;
+            for_each_chunk(session, [&ret](column_chunk<Type>& chunk) {
+                ret.append(chunk);
+            }, fetch_size);
+            return ret;
         }
 
+        /*! \fn void for_each_chunk(session::session_type& session, Func&& func, std::size_t fetch_size)
+         *  \brief Executes the query and hands the results over column-wise, chunk by chunk
+         *
+         *  The selected rows are fetched by soci::into(std::vector) per a declared member, up to \a fetch_size
+         *  rows at once, and are passed to the \a func as a column_chunk<Type>; no object is built.
+         *  The columns are reused by the next chunk.
+         *  \param session The session to be used
+         *  \param func A callable taking column_chunk<Type>&
+         *  \param fetch_size The maximum number of the rows in a chunk
+         */
+        template <class Func>
+        void for_each_chunk(session::session_type& session, Func&& func, std::size_t fetch_size = default_fetch_size)
+        {
+            assert(fetch_size > 0);
+
+            column_chunk<Type> chunk;
+            chunk.resize(fetch_size);
+            run(session, sql_builder(all_fields_tag {}),
+                [&chunk](soci::statement& st) {
+                    chunk.bind_into(st);
+                },
+                [&chunk, &func, fetch_size](soci::statement& statement) {
+                    statement.execute();
+
+                    // A chunk short of the fetch size is the last one, the statement is done
+                    while (statement.fetch()) {
+                        func(chunk);
+                        if (chunk.size() < fetch_size)
+                            break;
+                        chunk.resize(fetch_size);
+                    }
+                });
+        }
+
+        /*! \fn cursor<Type> stream(session_handle session, std::size_t batch_size)
+         *  \brief Executes the query and returns a cursor streaming the results by batches of \a batch_size
+         *  \param session A session or an rvalue session_proxy which is kept by the cursor
+         *  \param batch_size The maximum number of rows held in memory
+         */
+        query::cursor<Type> stream(session_handle session, std::size_t batch_size = query::cursor<Type>::default_batch_size)
+        {
+            return query::cursor<Type> { std::move(session), sql_builder(all_fields_tag {}), m_bindings, batch_size };
+        }
+
+        /*! \fn Type object(session::session_type& session)
+         *  \brief Executes the query limited to a row and returns the first object, a default one if none
+         */
         Type object(session::session_type& session)
         {
             Type ret {};
-            session << sql_builder(all_fields_tag {}), soci::into(ret);
+            details::row_into<Type> into(ret);
+            run(session, sql_builder(first_row_tag {}),
+                [&into](soci::statement& st) {
+                    into.bind(st);
+                },
+                [&into](soci::statement& statement) {
+                    if (statement.execute(true)) {
+                        into.post_fetch();
+                        finish(statement);
+                    }
+                });
             return ret;
         }
 
         int count(session::session_type& session)
         {
             int ret {};
-            session << sql_builder(count_tag {}), soci::into(ret);
+            run(session, sql_builder(count_tag {}),
+                [&ret](soci::statement& st) {
+                    st.exchange(soci::into(ret));
+                },
+                [](soci::statement& statement) {
+                    if (statement.execute(true))
+                        finish(statement);
+                });
             return ret;
         }
 
@@ -211,52 +719,480 @@ namespace query {
             return *this;
         }
 
+        /*! \fn projection<Type, ...> select(const Fields&... fields) const
+         *  \brief Restricts the selected columns to the DSL \a fields, e.g. select(fields_query<Type>::id)
+         *  \return A projection keeping the conditions, the order and the limit of the query
+         */
+        template <class... Fields>
+        auto select(const Fields&...) const
+        {
+            static_assert(sizeof...(Fields) > 0, "At least a field is to be selected");
+            return projection<Type, Fields::proto_args::child0::value...> { *this };
+        }
+
+        /*! \brief The type of the member of a DSL field
+         */
+        template <class Field>
+        using key_type = std::tuple_element_t<Field::proto_args::child0::value, typename type_meta_data::tuple_type>;
+
+        /*! \fn self_type& after(const Field& key, const key_type<Field>& value)
+         *  \brief Selects the rows following the \a value of the \a key in the ascending order (keyset pagination)
+         *
+         *  Unlike limit(n, offset) the preceding rows are sought, not read: with the \a key indexed every page
+         *  costs the same regardless its depth. The \a key is to be unique; the rows are ordered by the \a key unless
+         *  ordered explicitly, then by the \a key first in the same direction: any other order would skip or repeat
+         *  the rows across the pages, the query throws std::logic_error then. The conditions of where() are kept,
+         *  in parentheses. A next call replaces the value.
+         */
+        template <class Field>
+        self_type& after(const Field&, const key_type<Field>& value)
+        {
+            seek(Field::proto_args::child0::value, false, value);
+            return *this;
+        }
+
+        /*! \fn self_type& before(const Field& key, const key_type<Field>& value)
+         *  \brief Selects the rows preceding the \a value of the \a key in the descending order, see after()
+         */
+        template <class Field>
+        self_type& before(const Field&, const key_type<Field>& value)
+        {
+            seek(Field::proto_args::child0::value, true, value);
+            return *this;
+        }
+
+        /*! \fn pager<Type, ...> pages(session_handle session, const Field& key, std::size_t page_size) const
+         *  \brief Returns a range of the pages of \a page_size objects sought by the \a key, see after()
+         *
+         *  The pages start after the value given by after() (or before()) if any, from the first row otherwise.
+         *  The query is to be ordered by the \a key only, as by after().
+         *  \param session A session or an rvalue session_proxy which is kept by the pager
+         */
+        template <class Field>
+        auto pages(session_handle session, const Field&, std::size_t page_size) const
+        {
+            return pager<Type, Field::proto_args::child0::value> { std::move(session), *this, page_size };
+        }
+
     private:
+        template <class, size_t...>
+        friend class projection;
+
+        template <class, size_t>
+        friend class pager;
+
+        struct seek_type {
+            std::size_t field;
+            bool descending;
+            std::string placeholder;
+            std::size_t binding;
+        };
+
+        template <class Value>
+        void seek(std::size_t field, bool descending, const Value& value)
+        {
+            static_assert(std::is_constructible_v<query::bindings::value_type, const Value&>,
+                "The key is to be an int or a string");
+
+            if (m_seek) {
+                m_seek->field = field;
+                m_seek->descending = descending;
+                m_bindings.set(m_seek->binding, value);
+            } else {
+                const std::size_t binding = m_bindings.size();
+                m_seek = seek_type { .field = field,
+                    .descending = descending,
+                    .placeholder = m_bindings.add(value),
+                    .binding = binding };
+            }
+        }
+
+        /*! \fn bool ordered_by(std::size_t field, bool descending) const
+         *  \brief Checks the rows are ordered by the \a field first in the given direction, or not ordered explicitly
+         */
+        bool ordered_by(std::size_t field, bool descending) const
+        {
+            if (m_order_by.empty())
+                return true;
+
+            const order_by& first = m_order_by.front();
+            return first.fields.front() == type_meta_data::member_names()[field]
+                and (first.expr == order_by::expression::DESCENDING) == descending;
+        }
+
+        template <class Binder>
+        soci::statement& prepare(session::session_type& session, std::string_view sql, Binder&& binder)
+        {
+            return session.statements().prepare(session, sql,
+                [this, &binder](soci::statement& st) {
+                    std::forward<Binder>(binder)(st);
+                    m_bindings.bind(st);
+                });
+        }
+
+        /*! \fn void run(session::session_type& session, const std::string& sql, Binder&& binder, Func&& func)
+         *  \brief Passes the cached statement of the \a sql to the \a func, which is to fetch the results to the end
+         *
+         *  A SELECT stopped before SQLITE_DONE keeps the read transaction of the connection open while it is cached:
+         *  the SHARED lock blocks the commits of other connections, a WAL snapshot is pinned. Thus the statement
+         *  is evicted from the cache, i.e. finalized, if the \a func throws.
+         */
+        template <class Binder, class Func>
+        void run(session::session_type& session, const std::string& sql, Binder&& binder, Func&& func)
+        {
+            auto& statement = prepare(session, sql, std::forward<Binder>(binder));
+            try {
+                std::forward<Func>(func)(statement);
+            } catch (...) {
+                session.statements().erase(sql);
+                throw;
+            }
+        }
+
+        /*! \fn static void finish(soci::statement& statement)
+         *  \brief Steps the statement of a single row query to its end, no row is left to be overwritten
+         */
+        static void finish(soci::statement& statement)
+        {
+            while (statement.fetch()) {
+            }
+        }
+
         template <class Expr>
-        query_result_type eval(const Expr& expr) const
+        query_result_type eval(const Expr& expr)
         {
             static_assert(is_query_grammar<Expr>, "Invalid query grammar");
-            return boost::proto::eval(expr, query_context_type {});
+            return boost::proto::eval(expr, query_context_type { m_bindings });
         }
 
-        std::string sql_builder(base::type_in<all_fields_tag, count_tag> auto&& tag) const
+        std::string sql_builder(base::type_in<all_fields_tag, count_tag, first_row_tag> auto&& tag) const
         {
-            std::stringstream sql;
-            if constexpr (base::type_in<decltype(tag), all_fields_tag>) {
-                sql << "SELECT "
-                    << base::join(type_meta_data::member_names())
-                    << " FROM "
-                    << type_meta_data::table_name();
+            std::string sql {};
+            if constexpr (base::type_in<decltype(tag), all_fields_tag, first_row_tag>) {
+                sql = details::sql_text<Type>::select;
             } else if constexpr (base::type_in<decltype(tag), count_tag>) {
-                sql << "SELECT COUNT(*) FROM "
-                    << type_meta_data::table_name();
+                sql = details::sql_text<Type>::count;
             }
+            return sql + clauses(base::type_in<decltype(tag), first_row_tag>);
+        }
 
-            sql << m_sql_stream.str();
+        template <size_t... Idx>
+        std::string sql_builder(fields_tag<Idx...>) const
+        {
+            std::string sql { details::compose_s<details::select_fields_sql_builder<Type, Idx...>>::value };
+            return sql + clauses();
+        }
 
-            if (m_order_by.size()) {
-                sql << " ORDER BY "
-                    << boost::algorithm::join(
-                           m_order_by | boost::adaptors::transformed([](auto& order) {
-                               std::stringstream str {};
-                               str << base::join(order.fields) << " " << order.exprToString();
-                               return str.str();
-                           }),
-                           ",");
+        /*! \fn std::string clauses(bool first_row) const
+         *  \brief Returns the SQL following the column list: the conditions, the order and the limit
+         *  \param first_row Whether the limit is restricted to a single row
+         */
+        std::string clauses(bool first_row = false) const
+        {
+            std::string sql { m_sql };
+
+            if (m_seek) {
+                if (not ordered_by(m_seek->field, m_seek->descending))
+                    throw std::logic_error("A query sought by a key is to be ordered by the key first");
+
+                constexpr std::string_view where_prefix { " WHERE " };
+                assert(m_sql.empty() or m_sql.starts_with(where_prefix));
+
+                // Parenthesized, a disjunction of where() would escape the seek condition otherwise
+                const std::string_view key = type_meta_data::member_names()[m_seek->field];
+                const std::string condition = std::string { key } + (m_seek->descending ? " < " : " > ") + m_seek->placeholder;
+                sql = m_sql.empty()
+                    ? " WHERE " + condition
+                    : " WHERE (" + m_sql.substr(where_prefix.size()) + ") AND " + condition;
+
+                if (m_order_by.empty()) {
+                    sql += " ORDER BY ";
+                    sql += key;
+                    sql += m_seek->descending ? " DESC" : " ASC";
+                }
+            }
+
+            for (auto it = m_order_by.begin(); it != m_order_by.end(); ++it) {
+                sql += it == m_order_by.begin() ? " ORDER BY " : ",";
+                sql += base::join(it->fields);
+                sql += " ";
+                sql += it->exprToString();
             }
 
-            if (m_limit) {
-                sql << " LIMIT " << m_limit->first << " OFFSET " << m_limit->second;
+            if (m_limit or first_row) {
+                const std::size_t limit = m_limit ? m_limit->first : 1;
+                sql += " LIMIT ";
+                sql += std::to_string(first_row ? std::min<std::size_t>(limit, 1) : limit);
+                sql += " OFFSET ";
+                sql += std::to_string(m_limit ? m_limit->second : 0);
             }
 
-            return sql.str();
+            return sql;
         }
 
         using limit_offset_type = std::pair<std::size_t, std::size_t>;
 
-        std::stringstream m_sql_stream;
+        std::string m_sql;
+        query::bindings m_bindings;
         std::list<order_by> m_order_by;
         std::optional<limit_offset_type> m_limit;
+        std::optional<seek_type> m_seek;
+    };
+
+    /*! \brief The query results restricted to the members Idx... of Type
+     *
+     *  Only the selected columns are read and decoded, the rows are fetched in bulk as by from::for_each_chunk()
+     *  and returned either as tuples of the member types or as objects of a lighter aggregate, its members
+     *  initialized in the order of the selection.
+     */
+    template <class Type, size_t... Idx>
+    class projection {
+    public:
+        using self_type = projection<Type, Idx...>;
+
+        using query_type = from<Type>;
+
+        using chunk_type = details::projection_buffers<Type, Idx...>;
+
+        using tuple_type = typename chunk_type::values_type;
+
+        explicit projection(query_type query)
+            : m_query(std::move(query))
+        {
+        }
+
+        /*! \fn std::vector<tuple_type> tuples(session::session_type& session, std::size_t fetch_size)
+         *  \brief Executes the query and returns the selected values row by row
+         */
+        std::vector<tuple_type> tuples(session::session_type& session, std::size_t fetch_size = query_type::default_fetch_size)
+        {
+            return as<tuple_type>(session, fetch_size);
+        }
+
+        /*! \fn std::vector<Projected> as(session::session_type& session, std::size_t fetch_size)
+         *  \brief Executes the query and returns the rows as the \a Projected objects, built by {values...}
+         */
+        template <class Projected>
+        std::vector<Projected> as(session::session_type& session, std::size_t fetch_size = query_type::default_fetch_size)
+        {
+            std::vector<Projected> ret {};
+            for_each_chunk(session, [&ret](chunk_type& chunk) {
+                for (std::size_t row = 0; row < chunk.size(); ++row) {
+                    ret.push_back(make<Projected>(chunk, row, std::index_sequence_for<std::integral_constant<size_t, Idx>...> {}));
+                }
+            }, fetch_size);
+            return ret;
+        }
+
+        /*! \fn void for_each_chunk(session::session_type& session, Func&& func, std::size_t fetch_size)
+         *  \brief Executes the query and hands the selected columns over chunk by chunk, see from::for_each_chunk()
+         */
+        template <class Func>
+        void for_each_chunk(session::session_type& session, Func&& func, std::size_t fetch_size = query_type::default_fetch_size)
+        {
+            assert(fetch_size > 0);
+
+            chunk_type chunk;
+            chunk.resize(fetch_size);
+            m_query.run(session, m_query.sql_builder(fields_tag<Idx...> {}),
+                [&chunk](soci::statement& st) {
+                    chunk.bind_into(st);
+                },
+                [&chunk, &func, fetch_size](soci::statement& statement) {
+                    statement.execute();
+
+                    while (statement.fetch()) {
+                        func(chunk);
+                        if (chunk.size() < fetch_size)
+                            break;
+                        chunk.resize(fetch_size);
+                    }
+                });
+        }
+
+    private:
+        template <class Projected, size_t... Pos>
+        static Projected make(chunk_type& chunk, std::size_t row, std::index_sequence<Pos...>)
+        {
+            // The braced initialization takes the columns in order
+            return Projected { chunk.template take<Pos>(row)... };
+        }
+
+        query_type m_query;
+    };
+
+    /*! \brief An input range of the pages of a query sought by the Key-th member, see from::pages()
+     *
+     *  Each page is fetched by a query seeking the rows after the key of the last object of the previous page,
+     *  the SQL text is the same for all the pages but the first one, thus the statement is cached.
+     *  The pager keeps the session handle for its lifetime.
+     */
+    template <class Type, size_t Key>
+    class pager {
+    public:
+        using self_type = pager<Type, Key>;
+
+        using query_type = from<Type>;
+
+        using key_type = std::tuple_element_t<Key, typename details::type_meta_data<Type>::tuple_type>;
+
+        using page_type = std::vector<Type>;
+
+    private:
+        struct state {
+            state(session::session_type& session, query_type query, std::size_t size)
+                : db(session)
+                , query(std::move(query))
+                , page {}
+                , page_size(size)
+                , last_key { std::nullopt }
+                , exhausted(false)
+            {
+                assert(page_size > 0);
+                assert(not this->query.m_seek or this->query.m_seek->field == Key);
+
+                // The first page, not sought, is ordered as the next ones
+                if (not this->query.m_seek and not this->query.ordered_by(Key, false))
+                    throw std::logic_error("The pages are to be ordered by their key first");
+                if (not this->query.m_seek and this->query.m_order_by.empty()) {
+                    this->query.m_order_by.push_back({ .expr = query_type::order_by::expression::ASCENDING,
+                        .fields = { details::type_meta_data<Type>::member_names()[Key] } });
+                }
+                this->query.limit(page_size);
+            }
+
+            bool next()
+            {
+                page.clear();
+                if (exhausted)
+                    return false;
+
+                page = query.objects(db, page_size);
+                exhausted = page.size() < page_size;
+                if (page.empty())
+                    return false;
+
+                last_key = details::member_at<Key>(page.back());
+                query.seek(Key, query.m_seek and query.m_seek->descending, *last_key);
+                return true;
+            }
+
+            session::session_type& db;
+            query_type query;
+            page_type page;
+            const std::size_t page_size;
+            std::optional<key_type> last_key;
+            bool exhausted;
+        };
+
+    public:
+        class iterator {
+        public:
+            using iterator_concept = std::input_iterator_tag;
+
+            using iterator_category = std::input_iterator_tag;
+
+            using value_type = page_type;
+
+            using difference_type = std::ptrdiff_t;
+
+            using reference = page_type&;
+
+            using pointer = page_type*;
+
+            iterator()
+                : m_state(nullptr)
+            {
+            }
+
+            reference operator*() const
+            {
+                return m_state->page;
+            }
+
+            pointer operator->() const
+            {
+                return &m_state->page;
+            }
+
+            iterator& operator++()
+            {
+                if (not m_state->next())
+                    m_state = nullptr;
+                return *this;
+            }
+
+            void operator++(int)
+            {
+                ++*this;
+            }
+
+            friend bool operator==(const iterator& it, std::default_sentinel_t)
+            {
+                return it.m_state == nullptr;
+            }
+
+        private:
+            friend self_type;
+
+            explicit iterator(state* st)
+                : m_state(st)
+            {
+            }
+
+            state* m_state;
+        };
+
+        pager(session_handle session, query_type query, std::size_t page_size)
+            : m_session(std::move(session))
+            , m_state(std::make_unique<state>(m_session.get(), std::move(query), page_size))
+            , m_started(false)
+        {
+        }
+
+        pager(pager&&) = default;
+
+        /*! \fn pager& operator=(pager&& rhs)
+         *  \brief Releases the current state before the session its statement runs on
+         */
+        pager& operator=(pager&& rhs) noexcept
+        {
+            m_state = std::move(rhs.m_state);
+            m_session = std::move(rhs.m_session);
+            m_started = rhs.m_started;
+            return *this;
+        }
+
+        /*! \fn iterator begin()
+         *  \brief Returns an iterator to the current page; the first call fetches the first page
+         */
+        iterator begin()
+        {
+            if (not m_started) {
+                m_started = true;
+                if (not m_state->next())
+                    return iterator {};
+            }
+            return m_state->page.empty() ? iterator {} : iterator { m_state.get() };
+        }
+
+        std::default_sentinel_t end() const
+        {
+            return std::default_sentinel;
+        }
+
+        /*! \fn const std::optional<key_type>& last_key() const
+         *  \brief Returns the key of the last object fetched, e.g. to resume later by from::after()
+         */
+        const std::optional<key_type>& last_key() const
+        {
+            return m_state->last_key;
+        }
+
+    private:
+        session_handle m_session;
+        std::unique_ptr<state> m_state;
+        bool m_started;
     };
 
 } // namespace query
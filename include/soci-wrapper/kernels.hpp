@@ -0,0 +1,912 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && not defined(SW_KERNELS_SCALAR)
+#define SW_KERNELS_X86 1
+#define SW_KERNELS_AVX2 __attribute__((target("avx2,popcnt")))
+#include <immintrin.h>
+#endif
+
+namespace soci_wrapper {
+
+/*! \brief Filter and aggregate kernels over the columns of the fetched results
+ *
+ *  The kernels run over contiguous columns of double or std::int32_t, e.g. the ones of query::columns,
+ *  and cover the predicates which cannot be pushed into SQL. On x86-64 the SSE2 or the AVX2 code is chosen
+ *  at runtime by the CPU features, elsewhere (or with SW_KERNELS_SCALAR defined) the scalar code runs.
+ *  The sums of doubles are accumulated in several lanes, thus may differ from a sequential sum by rounding.
+ */
+namespace kernels {
+
+    enum class compare {
+        less,
+        less_equal,
+        greater,
+        greater_equal,
+        equal,
+        not_equal
+    };
+
+    /*! \brief The instruction sets of the kernels, in the ascending order
+     */
+    enum class isa {
+        scalar = 0,
+        sse2,
+        avx2
+    };
+
+    template <class Type>
+    concept kernel_value = std::same_as<Type, double> or std::same_as<Type, std::int32_t>;
+
+    template <class Type>
+    using sum_type = std::conditional_t<std::is_floating_point_v<Type>, double, std::int64_t>;
+
+    using mask_type = std::vector<std::uint8_t>;
+
+    /*! \brief The result of a filtered sum, the sum and the number of the values selected
+     */
+    template <class Type>
+    struct sum_count {
+        sum_type<Type> sum;
+        std::size_t count;
+    };
+
+    namespace details {
+
+        template <compare Op, class Type>
+        constexpr bool apply(Type lhs, Type rhs)
+        {
+            if constexpr (Op == compare::less)
+                return lhs < rhs;
+            else if constexpr (Op == compare::less_equal)
+                return lhs <= rhs;
+            else if constexpr (Op == compare::greater)
+                return lhs > rhs;
+            else if constexpr (Op == compare::greater_equal)
+                return lhs >= rhs;
+            else if constexpr (Op == compare::equal)
+                return lhs == rhs;
+            else
+                return lhs != rhs;
+        }
+
+        /*! \fn decltype(auto) with_compare(compare op, Func&& func)
+         *  \brief Calls the \a func with the \a op turned into a compile time constant
+         */
+        template <class Func>
+        decltype(auto) with_compare(compare op, Func&& func)
+        {
+            switch (op) {
+            case compare::less:
+                return func(std::integral_constant<compare, compare::less> {});
+            case compare::less_equal:
+                return func(std::integral_constant<compare, compare::less_equal> {});
+            case compare::greater:
+                return func(std::integral_constant<compare, compare::greater> {});
+            case compare::greater_equal:
+                return func(std::integral_constant<compare, compare::greater_equal> {});
+            case compare::equal:
+                return func(std::integral_constant<compare, compare::equal> {});
+            default:
+                return func(std::integral_constant<compare, compare::not_equal> {});
+            }
+        }
+
+        /*! \fn void store_bits(std::uint8_t* out, unsigned bits, std::size_t lanes)
+         *  \brief Writes the \a lanes lowest \a bits of a comparison as the bytes of a mask, four at once
+         */
+        inline void store_bits(std::uint8_t* out, unsigned bits, std::size_t lanes)
+        {
+            // The bytes of the mask of a nibble, the least significant bit first
+            static constexpr auto nibbles = [] {
+                std::array<std::uint32_t, 16> ret {};
+                for (unsigned nibble = 0; nibble < ret.size(); ++nibble) {
+                    std::uint8_t bytes[4] = { std::uint8_t(nibble & 1), std::uint8_t((nibble >> 1) & 1),
+                        std::uint8_t((nibble >> 2) & 1), std::uint8_t((nibble >> 3) & 1) };
+                    ret[nibble] = std::bit_cast<std::uint32_t>(bytes);
+                }
+                return ret;
+            }();
+
+            for (std::size_t lane = 0; lane < lanes; lane += 4, bits >>= 4) {
+                if (lanes - lane >= 4) {
+                    std::memcpy(out + lane, &nibbles[bits & 0xF], 4);
+                } else {
+                    for (std::size_t idx = lane; idx < lanes; ++idx, bits >>= 1) {
+                        out[idx] = bits & 1;
+                    }
+                }
+            }
+        }
+
+        namespace scalar {
+
+            template <class Type>
+            sum_type<Type> sum(const Type* data, std::size_t size)
+            {
+                sum_type<Type> ret {};
+                for (std::size_t idx = 0; idx < size; ++idx) {
+                    ret += data[idx];
+                }
+                return ret;
+            }
+
+            template <class Type>
+            sum_type<Type> sum(const Type* data, const std::uint8_t* mask, std::size_t size)
+            {
+                sum_type<Type> ret {};
+                for (std::size_t idx = 0; idx < size; ++idx) {
+                    ret += mask[idx] ? data[idx] : Type {};
+                }
+                return ret;
+            }
+
+            template <class Type>
+            Type min(const Type* data, std::size_t size)
+            {
+                Type ret = data[0];
+                for (std::size_t idx = 1; idx < size; ++idx) {
+                    ret = data[idx] < ret ? data[idx] : ret;
+                }
+                return ret;
+            }
+
+            template <class Type>
+            Type max(const Type* data, std::size_t size)
+            {
+                Type ret = data[0];
+                for (std::size_t idx = 1; idx < size; ++idx) {
+                    ret = data[idx] > ret ? data[idx] : ret;
+                }
+                return ret;
+            }
+
+            template <compare Op, class Type>
+            std::size_t mask(const Type* data, std::size_t size, Type value, std::uint8_t* out)
+            {
+                std::size_t ret = 0;
+                for (std::size_t idx = 0; idx < size; ++idx) {
+                    const bool matched = apply<Op>(data[idx], value);
+                    if (out)
+                        out[idx] = matched;
+                    ret += matched;
+                }
+                return ret;
+            }
+
+            template <compare Op, class Type>
+            sum_count<Type> sum_if(const Type* data, std::size_t size, Type value)
+            {
+                sum_count<Type> ret {};
+                for (std::size_t idx = 0; idx < size; ++idx) {
+                    const bool matched = apply<Op>(data[idx], value);
+                    ret.sum += matched ? data[idx] : Type {};
+                    ret.count += matched;
+                }
+                return ret;
+            }
+
+        } // namespace scalar
+
+#ifdef SW_KERNELS_X86
+        namespace sse2 {
+
+            // The baseline x86-64 has no popcnt instruction, the lanes of SSE2 are few enough for a table
+            inline unsigned lanes_count(unsigned bits)
+            {
+                static constexpr std::uint8_t counts[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+                return counts[bits & 0xF];
+            }
+
+            inline double sum(const double* data, std::size_t size)
+            {
+                __m128d acc0 = _mm_setzero_pd();
+                __m128d acc1 = _mm_setzero_pd();
+                std::size_t idx = 0;
+                for (; idx + 4 <= size; idx += 4) {
+                    acc0 = _mm_add_pd(acc0, _mm_loadu_pd(data + idx));
+                    acc1 = _mm_add_pd(acc1, _mm_loadu_pd(data + idx + 2));
+                }
+
+                double lanes[2];
+                _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+                return lanes[0] + lanes[1] + scalar::sum(data + idx, size - idx);
+            }
+
+            inline std::int64_t sum(const std::int32_t* data, std::size_t size)
+            {
+                __m128i acc = _mm_setzero_si128();
+                std::size_t idx = 0;
+                for (; idx + 4 <= size; idx += 4) {
+                    const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx));
+                    const __m128i sign = _mm_srai_epi32(values, 31);
+                    acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(values, sign));
+                    acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(values, sign));
+                }
+
+                std::int64_t lanes[2];
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+                return lanes[0] + lanes[1] + scalar::sum(data + idx, size - idx);
+            }
+
+            inline double min(const double* data, std::size_t size)
+            {
+                __m128d ret = _mm_set1_pd(data[0]);
+                std::size_t idx = 0;
+                for (; idx + 2 <= size; idx += 2) {
+                    ret = _mm_min_pd(ret, _mm_loadu_pd(data + idx));
+                }
+
+                double lanes[2];
+                _mm_storeu_pd(lanes, ret);
+                const double tail = idx < size ? scalar::min(data + idx, size - idx) : lanes[0];
+                return std::min({ lanes[0], lanes[1], tail });
+            }
+
+            inline double max(const double* data, std::size_t size)
+            {
+                __m128d ret = _mm_set1_pd(data[0]);
+                std::size_t idx = 0;
+                for (; idx + 2 <= size; idx += 2) {
+                    ret = _mm_max_pd(ret, _mm_loadu_pd(data + idx));
+                }
+
+                double lanes[2];
+                _mm_storeu_pd(lanes, ret);
+                const double tail = idx < size ? scalar::max(data + idx, size - idx) : lanes[0];
+                return std::max({ lanes[0], lanes[1], tail });
+            }
+
+            inline __m128i select_less(__m128i lhs, __m128i rhs)
+            {
+                const __m128i greater = _mm_cmpgt_epi32(lhs, rhs);
+                return _mm_or_si128(_mm_and_si128(greater, rhs), _mm_andnot_si128(greater, lhs));
+            }
+
+            inline __m128i select_greater(__m128i lhs, __m128i rhs)
+            {
+                const __m128i greater = _mm_cmpgt_epi32(lhs, rhs);
+                return _mm_or_si128(_mm_and_si128(greater, lhs), _mm_andnot_si128(greater, rhs));
+            }
+
+            inline std::int32_t min(const std::int32_t* data, std::size_t size)
+            {
+                __m128i ret = _mm_set1_epi32(data[0]);
+                std::size_t idx = 0;
+                for (; idx + 4 <= size; idx += 4) {
+                    ret = select_less(ret, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx)));
+                }
+
+                std::int32_t lanes[4];
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), ret);
+                const std::int32_t tail = idx < size ? scalar::min(data + idx, size - idx) : lanes[0];
+                return std::min({ lanes[0], lanes[1], lanes[2], lanes[3], tail });
+            }
+
+            inline std::int32_t max(const std::int32_t* data, std::size_t size)
+            {
+                __m128i ret = _mm_set1_epi32(data[0]);
+                std::size_t idx = 0;
+                for (; idx + 4 <= size; idx += 4) {
+                    ret = select_greater(ret, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx)));
+                }
+
+                std::int32_t lanes[4];
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), ret);
+                const std::int32_t tail = idx < size ? scalar::max(data + idx, size - idx) : lanes[0];
+                return std::max({ lanes[0], lanes[1], lanes[2], lanes[3], tail });
+            }
+
+            template <compare Op>
+            __m128d compare_lanes(__m128d values, __m128d value)
+            {
+                if constexpr (Op == compare::less)
+                    return _mm_cmplt_pd(values, value);
+                else if constexpr (Op == compare::less_equal)
+                    return _mm_cmple_pd(values, value);
+                else if constexpr (Op == compare::greater)
+                    return _mm_cmpgt_pd(values, value);
+                else if constexpr (Op == compare::greater_equal)
+                    return _mm_cmpge_pd(values, value);
+                else if constexpr (Op == compare::equal)
+                    return _mm_cmpeq_pd(values, value);
+                else
+                    return _mm_cmpneq_pd(values, value);
+            }
+
+            template <compare Op>
+            __m128i compare_lanes(__m128i values, __m128i value)
+            {
+                const __m128i all = _mm_set1_epi32(-1);
+                if constexpr (Op == compare::less)
+                    return _mm_cmplt_epi32(values, value);
+                else if constexpr (Op == compare::less_equal)
+                    return _mm_xor_si128(_mm_cmpgt_epi32(values, value), all);
+                else if constexpr (Op == compare::greater)
+                    return _mm_cmpgt_epi32(values, value);
+                else if constexpr (Op == compare::greater_equal)
+                    return _mm_xor_si128(_mm_cmplt_epi32(values, value), all);
+                else if constexpr (Op == compare::equal)
+                    return _mm_cmpeq_epi32(values, value);
+                else
+                    return _mm_xor_si128(_mm_cmpeq_epi32(values, value), all);
+            }
+
+            template <compare Op>
+            unsigned compare_bits(__m128d values, __m128d value)
+            {
+                return _mm_movemask_pd(compare_lanes<Op>(values, value));
+            }
+
+            template <compare Op>
+            unsigned compare_bits(__m128i values, __m128i value)
+            {
+                return _mm_movemask_ps(_mm_castsi128_ps(compare_lanes<Op>(values, value)));
+            }
+
+            template <compare Op>
+            std::size_t mask(const double* data, std::size_t size, double value, std::uint8_t* out)
+            {
+                const __m128d broadcast = _mm_set1_pd(value);
+                std::size_t ret = 0;
+                std::size_t idx = 0;
+                for (; idx + 2 <= size; idx += 2) {
+                    const unsigned bits = compare_bits<Op>(_mm_loadu_pd(data + idx), broadcast);
+                    ret += lanes_count(bits);
+                    if (out)
+                        store_bits(out + idx, bits, 2);
+                }
+                return ret + scalar::mask<Op>(data + idx, size - idx, value, out ? out + idx : nullptr);
+            }
+
+            template <compare Op>
+            std::size_t mask(const std::int32_t* data, std::size_t size, std::int32_t value, std::uint8_t* out)
+            {
+                const __m128i broadcast = _mm_set1_epi32(value);
+                std::size_t ret = 0;
+                std::size_t idx = 0;
+                for (; idx + 4 <= size; idx += 4) {
+                    const unsigned bits = compare_bits<Op>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx)), broadcast);
+                    ret += lanes_count(bits);
+                    if (out)
+                        store_bits(out + idx, bits, 4);
+                }
+                return ret + scalar::mask<Op>(data + idx, size - idx, value, out ? out + idx : nullptr);
+            }
+
+            template <class Type>
+            sum_type<Type> sum(const Type* data, const std::uint8_t* mask, std::size_t size)
+            {
+                return scalar::sum(data, mask, size);
+            }
+
+            template <compare Op>
+            sum_count<double> sum_if(const double* data, std::size_t size, double value)
+            {
+                const __m128d broadcast = _mm_set1_pd(value);
+                __m128d acc = _mm_setzero_pd();
+                std::size_t count = 0;
+                std::size_t idx = 0;
+                for (; idx + 2 <= size; idx += 2) {
+                    const __m128d values = _mm_loadu_pd(data + idx);
+                    const __m128d matched = compare_lanes<Op>(values, broadcast);
+                    acc = _mm_add_pd(acc, _mm_and_pd(values, matched));
+                    count += lanes_count(_mm_movemask_pd(matched));
+                }
+
+                double lanes[2];
+                _mm_storeu_pd(lanes, acc);
+                const auto tail = scalar::sum_if<Op>(data + idx, size - idx, value);
+                return { lanes[0] + lanes[1] + tail.sum, count + tail.count };
+            }
+
+            template <compare Op>
+            sum_count<std::int32_t> sum_if(const std::int32_t* data, std::size_t size, std::int32_t value)
+            {
+                const __m128i broadcast = _mm_set1_epi32(value);
+                __m128i acc = _mm_setzero_si128();
+                std::size_t count = 0;
+                std::size_t idx = 0;
+                for (; idx + 4 <= size; idx += 4) {
+                    const __m128i loaded = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx));
+                    const __m128i matched = compare_lanes<Op>(loaded, broadcast);
+                    const __m128i values = _mm_and_si128(loaded, matched);
+                    const __m128i sign = _mm_srai_epi32(values, 31);
+                    acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(values, sign));
+                    acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(values, sign));
+                    count += lanes_count(_mm_movemask_ps(_mm_castsi128_ps(matched)));
+                }
+
+                std::int64_t lanes[2];
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+                const auto tail = scalar::sum_if<Op>(data + idx, size - idx, value);
+                return { lanes[0] + lanes[1] + tail.sum, count + tail.count };
+            }
+
+        } // namespace sse2
+
+        namespace avx2 {
+
+            SW_KERNELS_AVX2 inline double sum(const double* data, std::size_t size)
+            {
+                __m256d acc0 = _mm256_setzero_pd();
+                __m256d acc1 = _mm256_setzero_pd();
+                std::size_t idx = 0;
+                for (; idx + 8 <= size; idx += 8) {
+                    acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(data + idx));
+                    acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(data + idx + 4));
+                }
+
+                double lanes[4];
+                _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+                return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + scalar::sum(data + idx, size - idx);
+            }
+
+            SW_KERNELS_AVX2 inline __m256i widen_add(__m256i acc, __m256i values)
+            {
+                acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(values)));
+                return _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(values, 1)));
+            }
+
+            SW_KERNELS_AVX2 inline std::int64_t reduce(__m256i acc)
+            {
+                std::int64_t lanes[4];
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+                return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+            }
+
+            SW_KERNELS_AVX2 inline std::int64_t sum(const std::int32_t* data, std::size_t size)
+            {
+                __m256i acc = _mm256_setzero_si256();
+                std::size_t idx = 0;
+                for (; idx + 8 <= size; idx += 8) {
+                    acc = widen_add(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + idx)));
+                }
+                return reduce(acc) + scalar::sum(data + idx, size - idx);
+            }
+
+            SW_KERNELS_AVX2 inline double min(const double* data, std::size_t size)
+            {
+                __m256d ret = _mm256_set1_pd(data[0]);
+                std::size_t idx = 0;
+                for (; idx + 4 <= size; idx += 4) {
+                    ret = _mm256_min_pd(ret, _mm256_loadu_pd(data + idx));
+                }
+
+                double lanes[4];
+                _mm256_storeu_pd(lanes, ret);
+                const double tail = idx < size ? scalar::min(data + idx, size - idx) : lanes[0];
+                return std::min({ lanes[0], lanes[1], lanes[2], lanes[3], tail });
+            }
+
+            SW_KERNELS_AVX2 inline double max(const double* data, std::size_t size)
+            {
+                __m256d ret = _mm256_set1_pd(data[0]);
+                std::size_t idx = 0;
+                for (; idx + 4 <= size; idx += 4) {
+                    ret = _mm256_max_pd(ret, _mm256_loadu_pd(data + idx));
+                }
+
+                double lanes[4];
+                _mm256_storeu_pd(lanes, ret);
+                const double tail = idx < size ? scalar::max(data + idx, size - idx) : lanes[0];
+                return std::max({ lanes[0], lanes[1], lanes[2], lanes[3], tail });
+            }
+
+            SW_KERNELS_AVX2 inline std::int32_t min(const std::int32_t* data, std::size_t size)
+            {
+                __m256i ret = _mm256_set1_epi32(data[0]);
+                std::size_t idx = 0;
+                for (; idx + 8 <= size; idx += 8) {
+                    ret = _mm256_min_epi32(ret, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + idx)));
+                }
+
+                std::int32_t lanes[8];
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), ret);
+                std::int32_t result = idx < size ? scalar::min(data + idx, size - idx) : lanes[0];
+                for (std::int32_t lane : lanes) {
+                    result = std::min(result, lane);
+                }
+                return result;
+            }
+
+            SW_KERNELS_AVX2 inline std::int32_t max(const std::int32_t* data, std::size_t size)
+            {
+                __m256i ret = _mm256_set1_epi32(data[0]);
+                std::size_t idx = 0;
+                for (; idx + 8 <= size; idx += 8) {
+                    ret = _mm256_max_epi32(ret, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + idx)));
+                }
+
+                std::int32_t lanes[8];
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), ret);
+                std::int32_t result = idx < size ? scalar::max(data + idx, size - idx) : lanes[0];
+                for (std::int32_t lane : lanes) {
+                    result = std::max(result, lane);
+                }
+                return result;
+            }
+
+            template <compare Op>
+            SW_KERNELS_AVX2 __m256d compare_lanes(__m256d values, __m256d value)
+            {
+                if constexpr (Op == compare::less)
+                    return _mm256_cmp_pd(values, value, _CMP_LT_OQ);
+                else if constexpr (Op == compare::less_equal)
+                    return _mm256_cmp_pd(values, value, _CMP_LE_OQ);
+                else if constexpr (Op == compare::greater)
+                    return _mm256_cmp_pd(values, value, _CMP_GT_OQ);
+                else if constexpr (Op == compare::greater_equal)
+                    return _mm256_cmp_pd(values, value, _CMP_GE_OQ);
+                else if constexpr (Op == compare::equal)
+                    return _mm256_cmp_pd(values, value, _CMP_EQ_OQ);
+                else
+                    return _mm256_cmp_pd(values, value, _CMP_NEQ_UQ);
+            }
+
+            template <compare Op>
+            SW_KERNELS_AVX2 __m256i compare_lanes(__m256i values, __m256i value)
+            {
+                const __m256i all = _mm256_set1_epi32(-1);
+                if constexpr (Op == compare::less)
+                    return _mm256_cmpgt_epi32(value, values);
+                else if constexpr (Op == compare::less_equal)
+                    return _mm256_xor_si256(_mm256_cmpgt_epi32(values, value), all);
+                else if constexpr (Op == compare::greater)
+                    return _mm256_cmpgt_epi32(values, value);
+                else if constexpr (Op == compare::greater_equal)
+                    return _mm256_xor_si256(_mm256_cmpgt_epi32(value, values), all);
+                else if constexpr (Op == compare::equal)
+                    return _mm256_cmpeq_epi32(values, value);
+                else
+                    return _mm256_xor_si256(_mm256_cmpeq_epi32(values, value), all);
+            }
+
+            template <compare Op>
+            SW_KERNELS_AVX2 unsigned compare_bits(__m256d values, __m256d value)
+            {
+                return _mm256_movemask_pd(compare_lanes<Op>(values, value));
+            }
+
+            template <compare Op>
+            SW_KERNELS_AVX2 unsigned compare_bits(__m256i values, __m256i value)
+            {
+                return _mm256_movemask_ps(_mm256_castsi256_ps(compare_lanes<Op>(values, value)));
+            }
+
+            template <compare Op>
+            SW_KERNELS_AVX2 std::size_t mask(const double* data, std::size_t size, double value, std::uint8_t* out)
+            {
+                const __m256d broadcast = _mm256_set1_pd(value);
+                std::size_t ret = 0;
+                std::size_t idx = 0;
+                for (; idx + 4 <= size; idx += 4) {
+                    const unsigned bits = compare_bits<Op>(_mm256_loadu_pd(data + idx), broadcast);
+                    ret += std::popcount(bits);
+                    if (out)
+                        store_bits(out + idx, bits, 4);
+                }
+                return ret + scalar::mask<Op>(data + idx, size - idx, value, out ? out + idx : nullptr);
+            }
+
+            template <compare Op>
+            SW_KERNELS_AVX2 std::size_t mask(const std::int32_t* data, std::size_t size, std::int32_t value, std::uint8_t* out)
+            {
+                const __m256i broadcast = _mm256_set1_epi32(value);
+                std::size_t ret = 0;
+                std::size_t idx = 0;
+                for (; idx + 8 <= size; idx += 8) {
+                    const unsigned bits = compare_bits<Op>(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + idx)), broadcast);
+                    ret += std::popcount(bits);
+                    if (out)
+                        store_bits(out + idx, bits, 8);
+                }
+                return ret + scalar::mask<Op>(data + idx, size - idx, value, out ? out + idx : nullptr);
+            }
+
+            SW_KERNELS_AVX2 inline double sum(const double* data, const std::uint8_t* mask, std::size_t size)
+            {
+                const __m256i zero = _mm256_setzero_si256();
+                __m256d acc = _mm256_setzero_pd();
+                std::size_t idx = 0;
+                for (; idx + 4 <= size; idx += 4) {
+                    std::int32_t bytes;
+                    std::memcpy(&bytes, mask + idx, sizeof(bytes));
+                    const __m256i selected = _mm256_cmpgt_epi64(_mm256_cvtepu8_epi64(_mm_cvtsi32_si128(bytes)), zero);
+                    acc = _mm256_add_pd(acc, _mm256_and_pd(_mm256_loadu_pd(data + idx), _mm256_castsi256_pd(selected)));
+                }
+
+                double lanes[4];
+                _mm256_storeu_pd(lanes, acc);
+                return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + scalar::sum(data + idx, mask + idx, size - idx);
+            }
+
+            SW_KERNELS_AVX2 inline std::int64_t sum(const std::int32_t* data, const std::uint8_t* mask, std::size_t size)
+            {
+                const __m256i zero = _mm256_setzero_si256();
+                __m256i acc = _mm256_setzero_si256();
+                std::size_t idx = 0;
+                for (; idx + 8 <= size; idx += 8) {
+                    const __m256i selected = _mm256_cmpgt_epi32(
+                        _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(mask + idx))), zero);
+                    const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + idx));
+                    acc = widen_add(acc, _mm256_and_si256(values, selected));
+                }
+                return reduce(acc) + scalar::sum(data + idx, mask + idx, size - idx);
+            }
+
+            template <compare Op>
+            SW_KERNELS_AVX2 sum_count<double> sum_if(const double* data, std::size_t size, double value)
+            {
+                const __m256d broadcast = _mm256_set1_pd(value);
+                __m256d acc = _mm256_setzero_pd();
+                std::size_t count = 0;
+                std::size_t idx = 0;
+                for (; idx + 4 <= size; idx += 4) {
+                    const __m256d values = _mm256_loadu_pd(data + idx);
+                    const __m256d matched = compare_lanes<Op>(values, broadcast);
+                    acc = _mm256_add_pd(acc, _mm256_and_pd(values, matched));
+                    count += std::popcount(static_cast<unsigned>(_mm256_movemask_pd(matched)));
+                }
+
+                double lanes[4];
+                _mm256_storeu_pd(lanes, acc);
+                const auto tail = scalar::sum_if<Op>(data + idx, size - idx, value);
+                return { (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + tail.sum, count + tail.count };
+            }
+
+            template <compare Op>
+            SW_KERNELS_AVX2 sum_count<std::int32_t> sum_if(const std::int32_t* data, std::size_t size, std::int32_t value)
+            {
+                const __m256i broadcast = _mm256_set1_epi32(value);
+                __m256i acc = _mm256_setzero_si256();
+                std::size_t count = 0;
+                std::size_t idx = 0;
+                for (; idx + 8 <= size; idx += 8) {
+                    const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + idx));
+                    const __m256i matched = compare_lanes<Op>(values, broadcast);
+                    acc = widen_add(acc, _mm256_and_si256(values, matched));
+                    count += std::popcount(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(matched))));
+                }
+
+                const auto tail = scalar::sum_if<Op>(data + idx, size - idx, value);
+                return { reduce(acc) + tail.sum, count + tail.count };
+            }
+
+        } // namespace avx2
+#endif
+
+        inline isa detect()
+        {
+#ifdef SW_KERNELS_X86
+            return __builtin_cpu_supports("avx2") ? isa::avx2 : isa::sse2;
+#else
+            return isa::scalar;
+#endif
+        }
+
+        inline std::atomic<isa>& active()
+        {
+            static std::atomic<isa> value { detect() };
+            return value;
+        }
+
+        template <class Range>
+        auto values_of(const Range& values)
+        {
+            return std::span<const std::ranges::range_value_t<Range>>(std::ranges::data(values), std::ranges::size(values));
+        }
+
+    } // namespace details
+
+    template <class Range>
+    concept kernel_range = std::ranges::contiguous_range<Range> and std::ranges::sized_range<Range>
+        and kernel_value<std::ranges::range_value_t<Range>>;
+
+    template <kernel_range Range>
+    using value_of_t = std::ranges::range_value_t<Range>;
+
+    /*! \fn isa supported_isa()
+     *  \brief Returns the best instruction set supported by the CPU
+     */
+    inline isa supported_isa()
+    {
+        static const isa value = details::detect();
+        return value;
+    }
+
+    inline isa active_isa()
+    {
+        return details::active().load(std::memory_order_relaxed);
+    }
+
+    /*! \fn isa select_isa(isa value)
+     *  \brief Restricts the kernels to the instruction set \a value, e.g. to compare them with the scalar code
+     *  \return The instruction set selected, not above the supported one
+     */
+    inline isa select_isa(isa value)
+    {
+        value = std::min(value, supported_isa());
+        details::active().store(value, std::memory_order_relaxed);
+        return value;
+    }
+
+    /*! \fn sum_type<value_of_t<Range>> sum(const Range& range)
+     *  \brief Returns the sum of the values, the sum of std::int32_t is widened to std::int64_t
+     */
+    template <kernel_range Range>
+    sum_type<value_of_t<Range>> sum(const Range& range)
+    {
+        const auto values = details::values_of(range);
+        switch (active_isa()) {
+#ifdef SW_KERNELS_X86
+        case isa::avx2:
+            return details::avx2::sum(values.data(), values.size());
+        case isa::sse2:
+            return details::sse2::sum(values.data(), values.size());
+#endif
+        default:
+            return details::scalar::sum(values.data(), values.size());
+        }
+    }
+
+    /*! \fn sum_type<value_of_t<Range>> sum(const Range& range, const mask_type& mask)
+     *  \brief Returns the sum of the values selected by the \a mask, e.g. the one of filter_mask()
+     */
+    template <kernel_range Range>
+    sum_type<value_of_t<Range>> sum(const Range& range, const mask_type& mask)
+    {
+        const auto values = details::values_of(range);
+        const std::size_t size = std::min(values.size(), mask.size());
+        switch (active_isa()) {
+#ifdef SW_KERNELS_X86
+        case isa::avx2:
+            return details::avx2::sum(values.data(), mask.data(), size);
+        case isa::sse2:
+            return details::sse2::sum(values.data(), mask.data(), size);
+#endif
+        default:
+            return details::scalar::sum(values.data(), mask.data(), size);
+        }
+    }
+
+    /*! \fn std::optional<value_of_t<Range>> min(const Range& range)
+     *  \brief Returns the least of the values, none for an empty \a range
+     */
+    template <kernel_range Range>
+    std::optional<value_of_t<Range>> min(const Range& range)
+    {
+        const auto values = details::values_of(range);
+        if (values.empty())
+            return std::nullopt;
+
+        switch (active_isa()) {
+#ifdef SW_KERNELS_X86
+        case isa::avx2:
+            return details::avx2::min(values.data(), values.size());
+        case isa::sse2:
+            return details::sse2::min(values.data(), values.size());
+#endif
+        default:
+            return details::scalar::min(values.data(), values.size());
+        }
+    }
+
+    /*! \fn std::optional<value_of_t<Range>> max(const Range& range)
+     *  \brief Returns the greatest of the values, none for an empty \a range
+     */
+    template <kernel_range Range>
+    std::optional<value_of_t<Range>> max(const Range& range)
+    {
+        const auto values = details::values_of(range);
+        if (values.empty())
+            return std::nullopt;
+
+        switch (active_isa()) {
+#ifdef SW_KERNELS_X86
+        case isa::avx2:
+            return details::avx2::max(values.data(), values.size());
+        case isa::sse2:
+            return details::sse2::max(values.data(), values.size());
+#endif
+        default:
+            return details::scalar::max(values.data(), values.size());
+        }
+    }
+
+    namespace details {
+
+        template <class Type>
+        std::size_t mask(compare op, std::span<const Type> values, Type value, std::uint8_t* out)
+        {
+            return with_compare(op, [&](auto op) -> std::size_t {
+                switch (active_isa()) {
+#ifdef SW_KERNELS_X86
+                case isa::avx2:
+                    return avx2::mask<decltype(op)::value>(values.data(), values.size(), value, out);
+                case isa::sse2:
+                    return sse2::mask<decltype(op)::value>(values.data(), values.size(), value, out);
+#endif
+                default:
+                    return scalar::mask<decltype(op)::value>(values.data(), values.size(), value, out);
+                }
+            });
+        }
+
+    } // namespace details
+
+    /*! \fn std::size_t count(const Range& range, compare op, value_of_t<Range> value)
+     *  \brief Returns the number of the values satisfying "value op \a value"
+     */
+    template <kernel_range Range>
+    std::size_t count(const Range& range, compare op, value_of_t<Range> value)
+    {
+        return details::mask(op, details::values_of(range), value, nullptr);
+    }
+
+    /*! \fn std::size_t filter_mask(const Range& range, compare op, value_of_t<Range> value, mask_type& mask)
+     *  \brief Fills the \a mask with a byte per value, 1 if "value op \a value" is satisfied, 0 otherwise
+     *  \return The number of the values satisfying the predicate
+     */
+    template <kernel_range Range>
+    std::size_t filter_mask(const Range& range, compare op, value_of_t<Range> value, mask_type& mask)
+    {
+        const auto values = details::values_of(range);
+        mask.resize(values.size());
+        return details::mask(op, values, value, mask.data());
+    }
+
+    /*! \fn sum_count<value_of_t<Range>> sum_if(const Range& range, compare op, value_of_t<Range> value)
+     *  \brief Sums the values satisfying "value op \a value" in a single pass, without a mask
+     */
+    template <kernel_range Range>
+    sum_count<value_of_t<Range>> sum_if(const Range& range, compare op, value_of_t<Range> value)
+    {
+        using value_type = value_of_t<Range>;
+
+        const auto values = details::values_of(range);
+        return details::with_compare(op, [&](auto op) -> sum_count<value_type> {
+            constexpr compare predicate = decltype(op)::value;
+            switch (active_isa()) {
+#ifdef SW_KERNELS_X86
+            case isa::avx2:
+                return details::avx2::sum_if<predicate>(values.data(), values.size(), value);
+            case isa::sse2:
+                return details::sse2::sum_if<predicate>(values.data(), values.size(), value);
+#endif
+            default:
+                return details::scalar::sum_if<predicate>(values.data(), values.size(), value);
+            }
+        });
+    }
+
+    /*! \fn std::size_t mask_and(mask_type& mask, const mask_type& other)
+     *  \brief Combines the \a other predicate into the \a mask, the \a mask is truncated to the shorter one
+     *  \return The number of the values selected by both
+     */
+    inline std::size_t mask_and(mask_type& mask, const mask_type& other)
+    {
+        mask.resize(std::min(mask.size(), other.size()));
+        std::size_t ret = 0;
+        for (std::size_t idx = 0; idx < mask.size(); ++idx) {
+            mask[idx] &= other[idx];
+            ret += mask[idx];
+        }
+        return ret;
+    }
+
+} // namespace kernels
+} // namespace soci_wrapper
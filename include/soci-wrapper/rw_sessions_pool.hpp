@@ -0,0 +1,402 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "dml.hpp"
+#include "sessions_pool.hpp"
+
+namespace soci_wrapper {
+namespace details {
+
+    /*! \fn std::string sqlite_conn_string(const std::string& conn_string, const std::string& parameters)
+     *  \brief Appends the \a parameters to the \a conn_string, a bare file name becomes the \a db parameter
+     */
+    inline std::string sqlite_conn_string(const std::string& conn_string, const std::string& parameters)
+    {
+        if (conn_string.find('=') == std::string::npos)
+            return "db=" + conn_string + ' ' + parameters;
+        return conn_string + ' ' + parameters;
+    }
+
+} // namespace details
+
+/*! \brief A single-writer / multi-reader pool of the SQLite sessions
+ *
+ *  SQLite runs one write transaction at a time, the concurrent writers of a plain sessions_pool
+ *  collide on the database lock and spin in the busy handler. This pool switches the database
+ *  to the WAL journal and keeps two kinds of the sessions apart:
+ *  the read-only sessions are held by a sessions_pool and serve the queries concurrently,
+ *  the only read-write session is owned by a writer thread which executes the write jobs in the
+ *  submission order. The jobs queued while a transaction runs are committed together by the next one
+ *  (group commit), each of them within its own savepoint, thus a failed job is rolled back alone.
+ *  The future of a job is satisfied once its transaction is committed.
+ */
+template <class Session>
+class rw_sessions_pool : public std::enable_shared_from_this<rw_sessions_pool<Session>> {
+public:
+    using self_type = rw_sessions_pool<Session>;
+
+    using ptr_type = std::shared_ptr<self_type>;
+
+    using readers_pool_type = sessions_pool<Session>;
+
+    using readers_ptr_type = typename readers_pool_type::ptr_type;
+
+    using session_proxy = typename readers_pool_type::session_proxy;
+
+    using session_raw_type = typename Session::session_type;
+
+    using session_ptr_type = typename Session::session_ptr_type;
+
+    using clock_type = std::chrono::steady_clock;
+
+    /*! \brief The options of the pool
+     */
+    struct options_type {
+        /*! \brief The number of the read-only sessions, the number of the hardware threads if zero
+         */
+        size_t readers = 0;
+
+        /*! \brief The maximum number of the jobs committed by a single transaction
+         */
+        size_t group_size = 256;
+
+        /*! \brief The time a session waits for a database lock before SQLITE_BUSY
+         */
+        std::chrono::seconds busy_timeout { 5 };
+
+        /*! \brief The time read() waits for a busy read-only session
+         */
+        std::chrono::seconds read_timeout { 30 };
+
+        /*! \brief Syncs the WAL on the checkpoints only (PRAGMA synchronous = NORMAL)
+         */
+        bool synchronous_normal = true;
+    };
+
+    /*! \brief The counters of the writer
+     */
+    struct statistics_type {
+        /*! \brief The number of the executed jobs
+         */
+        size_t jobs = 0;
+
+        /*! \brief The number of the jobs which threw, the others of their transactions are kept
+         */
+        size_t failed_jobs = 0;
+
+        /*! \brief The number of the write transactions
+         */
+        size_t commits = 0;
+
+        /*! \brief The number of the transactions which failed to commit
+         */
+        size_t failed_commits = 0;
+    };
+
+    /*! \fn static ptr_type create(const std::string &conn_string, const options_type& options)
+     *  \brief Opens the writer session, switches the database to WAL and opens the readers
+     *  \param conn_string The connection string of the database
+     *  \param options The options of the pool
+     *  \return A pointer to the self type
+     */
+    static ptr_type create(const std::string& conn_string, const options_type& options = {})
+    {
+        ptr_type pool(new self_type(conn_string, options));
+        pool->m_writer_thread = std::jthread([pool = pool.get()](std::stop_token stop) {
+            pool->run(stop);
+        });
+        return pool;
+    }
+
+    rw_sessions_pool(const rw_sessions_pool&) = delete;
+
+    rw_sessions_pool& operator=(const rw_sessions_pool&) = delete;
+
+    /*! \brief Executes the queued jobs and stops the writer
+     */
+    ~rw_sessions_pool()
+    {
+        m_writer_thread.request_stop();
+        if (m_writer_thread.joinable())
+            m_writer_thread.join();
+    }
+
+    /*! \fn session_proxy get_reader()
+     *  \brief Acquires a read-only session
+     *  \return A session proxy, an empty one if all the readers are busy
+     */
+    session_proxy get_reader()
+    {
+        return m_readers->get_session();
+    }
+
+    /*! \fn std::optional<session_proxy> get_reader(std::chrono::duration<Rep, Period> timeout)
+     *  \brief Acquires a read-only session, waits up to the \a timeout for a busy one
+     */
+    template <class Rep, class Period>
+    std::optional<session_proxy> get_reader(std::chrono::duration<Rep, Period> timeout)
+    {
+        return m_readers->get_session(timeout);
+    }
+
+    /*! \fn auto read(Job&& job)
+     *  \brief Calls the \a job with a read-only session, waits up to options_type::read_timeout for a busy one
+     *  \return The result of the job
+     *  \throw std::runtime_error if no session is released in time
+     */
+    template <class Job>
+    auto read(Job&& job)
+    {
+        return read(std::forward<Job>(job), m_options.read_timeout);
+    }
+
+    /*! \fn auto read(Job&& job, std::chrono::duration<Rep, Period> timeout)
+     *  \brief Calls the \a job with a read-only session, waits up to the \a timeout for a busy one
+     *  \return The result of the job
+     *  \throw std::runtime_error if no session is released in time
+     */
+    template <class Job, class Rep, class Period>
+    auto read(Job&& job, std::chrono::duration<Rep, Period> timeout)
+    {
+        auto session = m_readers->get_session(timeout);
+        if (not session)
+            throw std::runtime_error("No read-only session is available");
+        return std::invoke(std::forward<Job>(job), static_cast<session_raw_type&>(*session));
+    }
+
+    /*! \fn auto write(Job&& job)
+     *  \brief Queues the \a job called with the writer session, e.g. a DML or DDL statement
+     *  \return A future of the job result, is satisfied once the job is committed
+     */
+    template <class Job>
+    auto write(Job&& job)
+    {
+        auto task = std::make_unique<write_job<std::decay_t<Job>>>(std::forward<Job>(job));
+        auto future = task->get_future();
+        {
+            std::lock_guard lock(m_mutex);
+            m_jobs.push_back(std::move(task));
+        }
+        m_wakeup.notify_one();
+        return future;
+    }
+
+    /*! \fn readers_ptr_type readers() const
+     *  \brief Returns the pool of the read-only sessions, e.g. for its metrics
+     */
+    readers_ptr_type readers() const
+    {
+        return m_readers;
+    }
+
+    /*! \fn size_t pending() const
+     *  \brief Returns the number of the queued write jobs
+     */
+    size_t pending() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_jobs.size();
+    }
+
+    statistics_type statistics() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_statistics;
+    }
+
+private:
+    struct write_job_base {
+        virtual ~write_job_base() = default;
+
+        /*! \fn virtual bool run(session_raw_type& session) noexcept
+         *  \brief Executes the job keeping its result or its exception
+         *  \return true if the job has succeeded
+         */
+        virtual bool run(session_raw_type& session) noexcept = 0;
+
+        /*! \fn virtual void complete(std::exception_ptr error) noexcept
+         *  \brief Satisfies the future once the transaction is over, the \a error of the commit overrides the result
+         */
+        virtual void complete(std::exception_ptr error) noexcept = 0;
+    };
+
+    template <class Job>
+    class write_job : public write_job_base {
+    public:
+        using result_type = std::invoke_result_t<Job&, session_raw_type&>;
+
+        explicit write_job(Job job)
+            : m_job(std::move(job))
+            , m_promise()
+            , m_result()
+            , m_error()
+        {
+        }
+
+        std::future<result_type> get_future()
+        {
+            return m_promise.get_future();
+        }
+
+        bool run(session_raw_type& session) noexcept override
+        {
+            try {
+                if constexpr (std::is_void_v<result_type>)
+                    std::invoke(m_job, session);
+                else
+                    m_result.emplace(std::invoke(m_job, session));
+                return true;
+            } catch (...) {
+                m_error = std::current_exception();
+                return false;
+            }
+        }
+
+        void complete(std::exception_ptr error) noexcept override
+        {
+            if (not error)
+                error = m_error;
+
+            try {
+                if (error)
+                    m_promise.set_exception(error);
+                else if constexpr (std::is_void_v<result_type>)
+                    m_promise.set_value();
+                else
+                    m_promise.set_value(std::move(*m_result));
+            } catch (...) {
+            }
+        }
+
+    private:
+        using storage_type = std::conditional_t<std::is_void_v<result_type>, std::monostate, std::optional<result_type>>;
+
+        Job m_job;
+        std::promise<result_type> m_promise;
+        storage_type m_result;
+        std::exception_ptr m_error;
+    };
+
+    using write_job_ptr_type = std::unique_ptr<write_job_base>;
+
+    rw_sessions_pool(const std::string& conn_string, const options_type& options)
+        : m_options(normalize(options))
+        , m_writer(Session::connect(details::sqlite_conn_string(conn_string,
+              "timeout=" + std::to_string(m_options.busy_timeout.count()))))
+        , m_readers()
+        , m_mutex()
+        , m_wakeup()
+        , m_jobs()
+        , m_statistics()
+        , m_writer_thread()
+    {
+        // The journal mode is kept by the database file, the readers open it in WAL already;
+        // an in-memory database stays in the memory mode and can not be shared anyway
+        std::string journal_mode;
+        *m_writer << "PRAGMA journal_mode = WAL", soci::into(journal_mode);
+        if (journal_mode != "wal")
+            throw std::runtime_error("The database can not be switched to WAL, the journal mode is " + journal_mode);
+        if (m_options.synchronous_normal)
+            *m_writer << "PRAGMA synchronous = NORMAL";
+
+        m_readers = readers_pool_type::create(
+            details::sqlite_conn_string(conn_string,
+                "readonly=true timeout=" + std::to_string(m_options.busy_timeout.count())),
+            { .min_size = m_options.readers, .max_size = m_options.readers });
+    }
+
+    static options_type normalize(options_type options)
+    {
+        if (options.readers == 0)
+            options.readers = std::max(1u, std::thread::hardware_concurrency());
+        options.group_size = std::max<size_t>(options.group_size, 1);
+        return options;
+    }
+
+    /*! \fn void run(std::stop_token stop)
+     *  \brief The writer loop, takes the queued jobs by groups; drains the queue on stop
+     */
+    void run(std::stop_token stop)
+    {
+        std::vector<write_job_ptr_type> group;
+        group.reserve(m_options.group_size);
+
+        for (;;) {
+            {
+                std::unique_lock lock(m_mutex);
+                m_wakeup.wait(lock, stop, [this] {
+                    return not m_jobs.empty();
+                });
+                if (m_jobs.empty())
+                    break;
+
+                while (not m_jobs.empty() and group.size() < m_options.group_size) {
+                    group.push_back(std::move(m_jobs.front()));
+                    m_jobs.pop_front();
+                }
+            }
+
+            commit(group);
+            group.clear();
+        }
+    }
+
+    void commit(std::vector<write_job_ptr_type>& group)
+    {
+        size_t failed = 0;
+        std::exception_ptr error;
+        try {
+            details::savepoint transaction(*m_writer);
+            for (auto& job : group) {
+                details::savepoint scope(*m_writer);
+                if (job->run(*m_writer))
+                    scope.release();
+                else
+                    ++failed;
+            }
+            transaction.release();
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard lock(m_mutex);
+            m_statistics.jobs += group.size();
+            m_statistics.failed_jobs += failed;
+            ++(error ? m_statistics.failed_commits : m_statistics.commits);
+        }
+
+        for (auto& job : group) {
+            job->complete(error);
+        }
+    }
+
+    const options_type m_options;
+    session_ptr_type m_writer;
+    readers_ptr_type m_readers;
+    mutable std::mutex m_mutex;
+    std::condition_variable_any m_wakeup;
+    std::deque<write_job_ptr_type> m_jobs;
+    statistics_type m_statistics;
+    std::jthread m_writer_thread;
+};
+
+} // namespace soci_wrapper
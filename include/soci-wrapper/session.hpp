@@ -1,5 +1,12 @@
 #pragma once
 
+#include <concepts>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "base/statement_cache.hpp"
 #include "soci/soci.h"
 
 #ifdef SW_SQLITE
@@ -7,9 +14,56 @@
 #endif
 
 namespace soci_wrapper {
+namespace details {
+
+    /*! \brief A soci::session extended by the cache of the prepared statements
+     *
+     *  The statements generated by the DML/DQL are cached per a session, thus a session taken
+     *  from the sessions_pool keeps its statements between the checkouts. open(), close() and reconnect()
+     *  drop the statements before the connection they belong to is released; those of soci::session
+     *  are not virtual, thus they are to be called through cached_session.
+     */
+    class cached_session : public soci::session {
+    public:
+        using soci::session::session;
+
+        template <class... Args>
+        void open(Args&&... args)
+        {
+            m_statements.clear();
+            soci::session::open(std::forward<Args>(args)...);
+        }
+
+        void close()
+        {
+            m_statements.clear();
+            soci::session::close();
+        }
+
+        void reconnect()
+        {
+            m_statements.clear();
+            soci::session::reconnect();
+        }
+
+        base::statement_cache& statements()
+        {
+            return m_statements;
+        }
+
+        const base::statement_cache& statements() const
+        {
+            return m_statements;
+        }
+
+    private:
+        base::statement_cache m_statements;
+    };
+
+} // namespace details
 
 struct session {
-    using session_type = soci::session;
+    using session_type = details::cached_session;
 
     using session_ptr_type = std::unique_ptr<session_type>;
 
@@ -44,4 +98,48 @@ struct session {
     }
 };
 
+/*! \brief A handle keeping a session reachable for a long-living object
+ *
+ *  Is created either from a session (or an lvalue convertible to it) which is borrowed and must outlive the handle,
+ *  or from an rvalue convertible to a session, e.g. sessions_pool::session_proxy, which is owned by the handle.
+ */
+class session_handle {
+public:
+    using session_type = session::session_type;
+
+    template <class Session>
+        requires(not std::same_as<std::remove_cv_t<Session>, session_handle> and std::convertible_to<Session&, session_type&>)
+    session_handle(Session& session)
+        : m_owner {}
+        , m_session(&static_cast<session_type&>(session))
+    {
+    }
+
+    template <class Proxy>
+        requires(not std::is_lvalue_reference_v<Proxy> and not std::same_as<std::remove_cv_t<Proxy>, session_handle>
+            and std::convertible_to<Proxy&, session_type&>)
+    session_handle(Proxy&& proxy)
+        : m_owner {}
+        , m_session(nullptr)
+    {
+        auto owner = std::make_shared<Proxy>(std::move(proxy));
+        m_session = &static_cast<session_type&>(*owner);
+        m_owner = std::move(owner);
+    }
+
+    session_type& get() const
+    {
+        return *m_session;
+    }
+
+    operator session_type&() const
+    {
+        return *m_session;
+    }
+
+private:
+    std::shared_ptr<void> m_owner;
+    session_type* m_session;
+};
+
 } // namespace soci_wrapper
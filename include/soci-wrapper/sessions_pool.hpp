@@ -1,19 +1,40 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
-#include <list>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
 #include <string>
+#include <thread>
+#include <vector>
 
-#include "base/lockable.hpp"
+#include "base/bounded_queue.hpp"
+#include "base/histogram.hpp"
 
 namespace soci_wrapper {
 
 /*! \brief A sessions pool class - creates and provides DB Connections
  *
- *  Creates and holds a list of connections to DB.
+ *  Creates and holds a ring of connections to DB.
  *  Once a client acquires a connections by using get_session(), the ownership is moved out
  *  from the objects towards client via session_proxy.
+ *  The idle sessions are kept in a bounded lock-free queue, thus neither the checkout nor the release
+ *  takes a lock or allocates unless a thread waits for a session.
+ *  With the thread affinity enabled, a released session is kept in a slot of the releasing thread
+ *  and is taken back by the same thread first; other threads steal it only when the ring is empty.
+ *  The pool opens min_size sessions in parallel, grows up to max_size while all the sessions are busy
+ *  and closes the sessions idle for longer than idle_ttl down to min_size by a background maintenance thread.
+ *  The sessions may be validated by a probe statement on the checkout and on the release; the broken ones
+ *  are closed and replaced by the maintenance thread, thus the callers never wait for a reconnection.
+ *  The maintenance thread runs only for an elastic or a validating pool, or once a metrics sink is installed;
+ *  a fixed pool opens a replacement of a closed session on demand, as it grows.
+ *  The usage is measured by lock-free counters and histograms, see metrics() and metrics_sink.
  */
 template <class Session>
 class sessions_pool : public std::enable_shared_from_this<sessions_pool<Session>> {
@@ -32,16 +53,162 @@ public:
 
     using weak_ptr_type = std::weak_ptr<self_type>;
 
-    using mutex_type = base::lockable::mutex_type;
+    using mutex_type = std::mutex;
 
-    using session_cont_type = std::list<session_ptr_type>;
+    using clock_type = std::chrono::steady_clock;
 
     struct session_proxy;
 
+    /*! \brief The counters of the sessions acquisitions
+     */
+    struct statistics_type {
+        /*! \brief The number of the acquisitions which found no idle session
+         */
+        size_t dry = 0;
+
+        /*! \brief The number of the acquisitions which waited for a session
+         */
+        size_t waits = 0;
+
+        /*! \brief The number of the waits which ran out of time
+         */
+        size_t timeouts = 0;
+
+        /*! \brief The total time spent by the waits
+         */
+        clock_type::duration wait_time {};
+
+        /*! \brief The number of the sessions opened on demand above min_size
+         */
+        size_t grown = 0;
+
+        /*! \brief The number of the idle sessions closed by the maintenance
+         */
+        size_t reaped = 0;
+
+        /*! \brief The number of the sessions found disconnected or failing the probe
+         */
+        size_t broken = 0;
+
+        /*! \brief The number of the sessions opened by the maintenance to replace the broken ones
+         */
+        size_t reconnects = 0;
+
+        /*! \brief The number of the replacements failed to connect, retried on the next maintenance
+         */
+        size_t reconnect_failures = 0;
+    };
+
+    using histogram_type = base::log2_histogram::snapshot_type;
+
+    /*! \brief A snapshot of the pool usage
+     */
+    struct metrics_type {
+        /*! \brief The number of the sessions held by the session proxies
+         */
+        size_t checked_out = 0;
+
+        /*! \brief The number of the idle sessions, see size()
+         */
+        size_t idle = 0;
+
+        /*! \brief The number of the sessions owned by the pool, see total()
+         */
+        size_t total = 0;
+
+        /*! \brief The maximum number of the sessions held at once
+         */
+        size_t peak_checked_out = 0;
+
+        /*! \brief The number of the checkouts which found no idle session
+         */
+        size_t exhausted = 0;
+
+        /*! \brief The latency of the successful checkouts, waiting included
+         */
+        histogram_type wait;
+
+        /*! \brief The time the sessions were held by the session proxies
+         */
+        histogram_type hold;
+    };
+
+    /*! \brief A receiver of the pool metrics
+     *
+     *  The sink is owned by the caller and must outlive its installation by set_metrics_sink().
+     */
+    struct metrics_sink {
+        virtual ~metrics_sink() = default;
+
+        /*! \fn virtual void exhausted(const self_type& pool)
+         *  \brief Is called by the thread which has found no idle session in the \a pool
+         */
+        virtual void exhausted([[maybe_unused]] const self_type& pool)
+        {
+        }
+
+        /*! \fn virtual void report(const metrics_type& metrics)
+         *  \brief Is called by the maintenance thread every maintenance_interval
+         */
+        virtual void report([[maybe_unused]] const metrics_type& metrics)
+        {
+        }
+    };
+
+    /*! \brief The sizing of the pool
+     */
+    struct options_type {
+        /*! \brief The number of the sessions opened on creation and kept open
+         */
+        size_t min_size = 1;
+
+        /*! \brief The maximum number of the sessions, min_size is used if less
+         */
+        size_t max_size = 0;
+
+        /*! \brief The time a session above min_size is kept idle, zero keeps it forever
+         */
+        std::chrono::milliseconds idle_ttl {};
+
+        /*! \brief Keeps a released session for the releasing thread
+         */
+        bool thread_affinity = false;
+
+        /*! \brief The statement validating a session, only is_connected() is checked if empty
+         */
+        std::string probe = "SELECT 1";
+
+        /*! \brief Validates a session before it is handed out
+         */
+        bool validate_on_borrow = false;
+
+        /*! \brief Validates a session when it is given back
+         */
+        bool validate_on_release = false;
+
+        /*! \brief The period of the maintenance: reaping and replacing of the broken sessions
+         */
+        std::chrono::milliseconds maintenance_interval { 1000 };
+    };
+
     sessions_pool(const sessions_pool&) = delete;
 
     sessions_pool& operator=(const sessions_pool&) = delete;
 
+    ~sessions_pool()
+    {
+        if (m_maintenance.joinable()) {
+            m_maintenance.request_stop();
+            m_maintenance.join();
+        }
+
+        while (pop_idle()) {
+        }
+        for (const auto& slot : m_slots) {
+            session_ptr_type(slot->session.exchange(nullptr));
+        }
+    }
+
     /*! \fn static ptr_type create(size_t size, const std::string &conn_string)
      *  \brief Creates (as a factory method) a pointer to the self type by passing
      *  \a size of connections to be established and \a conn_string as a connection string
@@ -51,16 +218,42 @@ public:
      */
     static ptr_type create(size_t size, const std::string& conn_string)
     {
-        return ptr_type(new self_type(size, conn_string));
+        return create(conn_string, { .min_size = size, .max_size = size });
+    }
+
+    /*! \fn static ptr_type create(size_t size, const std::string &conn_string, bool thread_affinity)
+     *  \brief Creates a pool as create(size, conn_string) does
+     *  \param thread_affinity Keeps a released session for the releasing thread
+     *  \return A pointer to the self type
+     */
+    static ptr_type create(size_t size, const std::string& conn_string, bool thread_affinity)
+    {
+        return create(conn_string, { .min_size = size, .max_size = size, .thread_affinity = thread_affinity });
+    }
+
+    /*! \fn static ptr_type create(const std::string &conn_string, const options_type& options)
+     *  \brief Creates a pool sized by the \a options, the initial sessions are opened in parallel
+     *  \param conn_string The connection string for establishing of the connections
+     *  \param options The sizing of the pool
+     *  \return A pointer to the self type
+     */
+    static ptr_type create(const std::string& conn_string, const options_type& options)
+    {
+        ptr_type pool(new self_type(conn_string, options));
+        const options_type& normalized = pool->m_options;
+        if (normalized.min_size < normalized.max_size or normalized.idle_ttl.count() > 0
+            or normalized.validate_on_borrow or normalized.validate_on_release)
+            pool->start_maintenance();
+        return pool;
     }
 
     /*! \fn static session_proxy get_empty_session()
-     *  \brief Creates empty session
-     *  \return Empty session proxy
+     *  \brief Creates empty session, neither allocates nor constructs one
+     *  \return Empty session proxy, not connected
      */
     static session_proxy get_empty_session()
     {
-        return session_proxy({}, session_type::connect());
+        return session_proxy({}, nullptr);
     }
 
     /*! \fn session_proxy get_session()
@@ -69,35 +262,145 @@ public:
      */
     session_proxy get_session()
     {
-        SW_LOCKABLE_ENTER_TO_WRITE(m_mutex);
-        if (m_idle.empty())
-            return get_empty_session();
+        const auto started = clock_type::now();
 
-        auto session = std::move(m_idle.front());
-        m_idle.pop_front();
+        // Each broken session is closed, thus the number of the attempts is bounded by the pool
+        for (size_t attempt = 0; attempt <= m_options.max_size; ++attempt) {
+            session_ptr_type session = acquire();
+            if (not session)
+                break;
+            if (check_out(session))
+                return make_proxy(std::move(session), started);
+        }
+
+        m_dry.fetch_add(1, std::memory_order_relaxed);
+        notify_exhausted();
+        return get_empty_session();
+    }
 
-        return session_proxy(this->weak_from_this(), std::move(session));
+    /*! \fn std::optional<session_proxy> get_session(std::chrono::duration<Rep, Period> timeout)
+     *  \brief Retrieves a session, waits up to \a timeout for a release if none is idle
+     *
+     *  The waiters are served in the FIFO order: a released session is handed over
+     *  to the oldest waiter directly.
+     *  \param timeout The maximum time to wait for a session
+     *  \return A valid session proxy; std::nullopt if the timeout has expired
+     */
+    template <class Rep, class Period>
+    std::optional<session_proxy> get_session(std::chrono::duration<Rep, Period> timeout)
+    {
+        const auto started = clock_type::now();
+        const auto deadline = started + std::chrono::ceil<clock_type::duration>(timeout);
+        for (;;) {
+            session_ptr_type session = wait_session(deadline);
+            if (not session)
+                return std::nullopt;
+            if (check_out(session))
+                return make_proxy(std::move(session), started);
+        }
     }
 
     /*! \fn void release_session(session_ptr_type session)
      *  \brief Releases a session which is held by session_proxy
+     *
+     *  The session is handed over to the oldest waiter if any; otherwise - is put to the idle ring.
+     *  A broken session is closed and replaced in the background.
      *  \param session A session pointer -- session_ptr_type
      */
     void release_session(session_ptr_type session)
     {
-        SW_LOCKABLE_ENTER_TO_WRITE(m_mutex);
-        if (session && session->is_connected())
-            m_idle.emplace_back(std::move(session));
+        if (not session)
+            return;
+
+        if (not session->is_connected() or (m_options.validate_on_release and not healthy(*session))) {
+            discard(std::move(session));
+            return;
+        }
+
+        // The slot is created by the checkout, the release (noexcept by session_proxy) allocates nothing;
+        // a session checked out by another thread goes to the ring
+        affine_slot* slot = m_options.thread_affinity and m_waiting.load() == 0 ? find_local_slot() : nullptr;
+        if (slot and keep(*slot, session)) {
+            // A waiter might have come after the check, the session is taken back for it
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_waiting.load() == 0)
+                return;
+
+            session = take(*slot);
+            std::lock_guard lock(m_mutex);
+            hand_over(std::move(session));
+            return;
+        }
+
+        release_shared(std::move(session));
+    }
+
+    /*! \fn statistics_type statistics() const
+     *  \brief Returns a copy of the acquisitions counters
+     */
+    statistics_type statistics() const
+    {
+        std::lock_guard lock(m_mutex);
+        return statistics_type {
+            .dry = m_dry.load(std::memory_order_relaxed),
+            .waits = m_waits,
+            .timeouts = m_timeouts,
+            .wait_time = m_wait_time,
+            .grown = m_grown.load(std::memory_order_relaxed),
+            .reaped = m_reaped.load(std::memory_order_relaxed),
+            .broken = m_broken.load(std::memory_order_relaxed),
+            .reconnects = m_reconnects.load(std::memory_order_relaxed),
+            .reconnect_failures = m_reconnect_failures.load(std::memory_order_relaxed)
+        };
+    }
+
+    /*! \fn metrics_type metrics() const
+     *  \brief Returns a snapshot of the usage metrics, neither locks nor allocates
+     */
+    metrics_type metrics() const
+    {
+        return metrics_type {
+            .checked_out = m_checked_out.load(std::memory_order_relaxed),
+            .idle = size(),
+            .total = total(),
+            .peak_checked_out = m_peak_checked_out.load(std::memory_order_relaxed),
+            .exhausted = m_dry.load(std::memory_order_relaxed),
+            .wait = m_wait_histogram.snapshot(),
+            .hold = m_hold_histogram.snapshot()
+        };
+    }
+
+    /*! \fn void set_metrics_sink(metrics_sink* sink)
+     *  \brief Installs the \a sink of the metrics, nullptr removes the current one
+     *
+     *  Returns once no call of the previous sink is in progress, thus it can be destroyed then;
+     *  must not be called from a sink call. Starts the maintenance thread, which reports to the sink, if none runs.
+     */
+    void set_metrics_sink(metrics_sink* sink)
+    {
+        if (sink)
+            start_maintenance();
+
+        m_sink.store(sink);
+        for (size_t users = m_sink_users.load(); users != 0; users = m_sink_users.load())
+            m_sink_users.wait(users);
+    }
+
+    /*! \fn size_t total() const
+     *  \brief Returns the number of the sessions owned by the pool, the idle and the checked out ones
+     */
+    size_t total() const
+    {
+        return m_total.load(std::memory_order_relaxed);
     }
 
     /*! \fn size_t size() const
      *  \brief Returns a size of the idle sessions and available for dispatching
-     *  \return Size of sessions stored in the idle list of the pool
+     *  \return Size of sessions stored in the idle ring of the pool, approximate under concurrency
      */
     size_t size() const
     {
-        SW_LOCKABLE_ENTER_TO_READ(m_mutex);
-        return m_idle.size();
+        return m_idle.size() + m_cached.load(std::memory_order_relaxed);
     }
 
     /*! \brief A proxy struct for the session transmitting
@@ -105,6 +408,8 @@ public:
      *  The struct wrapps a raw session and created by passing session_ptr_type
      *  During the object lifetime it holds a session. Once the object is deleted, it has returned
      *  the ownership back if session_pool is still alive
+     *  A moved-from or released proxy holds no session and is not connected; neither the checkout
+     *  nor the release allocates or constructs a session.
      */
     struct session_proxy {
         operator session_raw_type&()
@@ -130,21 +435,39 @@ public:
 
         session_proxy& operator=(const session_proxy&) = delete;
 
-        session_proxy(session_proxy&& other)
+        session_proxy(session_proxy&& other) noexcept
             : m_pool(std::move(other.m_pool))
             , m_session(std::move(other.m_session))
+            , m_acquired(other.m_acquired)
         {
         }
 
-        session_proxy& operator=(session_proxy&& other)
+        session_proxy& operator=(session_proxy&& other) noexcept
         {
-            swap(*this, other);
+            if (this != &other) {
+                release();
+                m_pool = std::move(other.m_pool);
+                m_session = std::move(other.m_session);
+                m_acquired = other.m_acquired;
+            }
             return *this;
         }
 
         ~session_proxy()
         {
-            release_session();
+            release();
+        }
+
+        /*! \fn void release()
+         *  \brief Returns the session back to the pool if it is still alive, the proxy becomes empty
+         */
+        void release() noexcept
+        {
+            if (auto pool = m_pool.lock())
+                pool->check_in(std::move(m_session), m_acquired);
+
+            m_pool.reset();
+            m_session.reset();
         }
 
     private:
@@ -155,41 +478,667 @@ public:
             using std::swap;
             swap(first.m_pool, second.m_pool);
             swap(first.m_session, second.m_session);
+            swap(first.m_acquired, second.m_acquired);
         }
 
-        session_proxy(weak_ptr_type pool, session_ptr_type session)
-            : m_pool(pool)
+        session_proxy(weak_ptr_type pool, session_ptr_type session, clock_type::time_point acquired = {})
+            : m_pool(std::move(pool))
             , m_session(std::move(session))
+            , m_acquired(acquired)
         {
         }
 
-        void release_session()
+        weak_ptr_type m_pool;
+        session_ptr_type m_session;
+        clock_type::time_point m_acquired;
+    };
+
+private:
+    /*! \brief A thread waiting for a session, lives on the stack of the waiting thread
+     */
+    struct waiter {
+        session_ptr_type session {};
+        waiter* prev = nullptr;
+        waiter* next = nullptr;
+    };
+
+    /*! \brief An intrusive FIFO list of the waiters, no allocation happens on a wait
+     */
+    class waiters_list {
+    public:
+        void push_back(waiter& node)
         {
-            if (!m_pool.expired()) {
-                m_pool.lock()->release_session(std::move(m_session));
+            node.prev = m_tail;
+            node.next = nullptr;
+            (m_tail ? m_tail->next : m_head) = &node;
+            m_tail = &node;
+        }
 
-                m_pool.reset();
-                m_session = session_type::connect();
+        bool empty() const
+        {
+            return m_head == nullptr;
+        }
+
+        waiter* pop_front()
+        {
+            waiter* node = m_head;
+            if (node)
+                erase(*node);
+            return node;
+        }
+
+        void erase(waiter& node)
+        {
+            (node.prev ? node.prev->next : m_head) = node.next;
+            (node.next ? node.next->prev : m_tail) = node.prev;
+            node.prev = node.next = nullptr;
+        }
+
+    private:
+        waiter* m_head = nullptr;
+        waiter* m_tail = nullptr;
+    };
+
+    /*! \brief A session kept for a thread, stolen by the others if the ring is empty
+     */
+    struct affine_slot {
+        std::atomic<session_raw_type*> session { nullptr };
+    };
+
+    using affine_slot_ptr = std::shared_ptr<affine_slot>;
+
+    /*! \brief The slots of a thread in the pools it used, returns the sessions kept once the thread exits
+     */
+    class thread_slots {
+    public:
+        ~thread_slots()
+        {
+            for (const auto& entry : m_entries) {
+                if (auto pool = entry.pool.lock())
+                    pool->detach(entry.slot);
             }
         }
 
-        weak_ptr_type m_pool;
-        session_ptr_type m_session;
+        affine_slot* find(const self_type& pool) const noexcept
+        {
+            for (const auto& entry : m_entries) {
+                if (entry.owner == &pool and not entry.pool.expired())
+                    return entry.slot.get();
+            }
+            return nullptr;
+        }
+
+        affine_slot& get(self_type& pool)
+        {
+            if (affine_slot* slot = find(pool))
+                return *slot;
+
+            std::erase_if(m_entries, [](const auto& entry) {
+                return entry.pool.expired();
+            });
+
+            auto slot = std::make_shared<affine_slot>();
+            pool.attach(slot);
+            m_entries.push_back({ &pool, pool.weak_from_this(), slot });
+            return *slot;
+        }
+
+    private:
+        struct entry {
+            const self_type* owner;
+            weak_ptr_type pool;
+            affine_slot_ptr slot;
+        };
+
+        std::vector<entry> m_entries;
     };
 
-private:
-    sessions_pool(size_t size, const std::string& conn_string)
-        : m_idle()
+    /*! \brief An idle session stamped by the time of its release
+     */
+    struct idle_entry {
+        session_raw_type* session = nullptr;
+        clock_type::time_point released {};
+    };
+
+    using session_cont_type = base::bounded_queue<idle_entry>;
+
+    static options_type normalize(options_type options)
+    {
+        options.max_size = std::max(options.min_size, options.max_size);
+        return options;
+    }
+
+    sessions_pool(const std::string& conn_string, const options_type& options)
+        : m_conn_string(conn_string)
+        , m_options(normalize(options))
+        , m_idle(m_options.max_size * 2)
+        , m_total(0)
+        , m_waiting(0)
+        , m_dry(0)
+        , m_grown(0)
+        , m_reaped(0)
+        , m_broken(0)
+        , m_reconnects(0)
+        , m_reconnect_failures(0)
+        , m_cached(0)
+        , m_checked_out(0)
+        , m_peak_checked_out(0)
+        , m_wait_histogram()
+        , m_hold_histogram()
+        , m_sink(nullptr)
+        , m_sink_users(0)
+        , m_slots()
+        , m_waiters()
+        , m_waits(0)
+        , m_timeouts(0)
+        , m_wait_time()
         , m_mutex()
+        , m_available()
+        , m_replenish(false)
+        , m_maintenance_wakeup()
+        , m_maintenance()
+    {
+        std::atomic<size_t> next = 0;
+        std::exception_ptr error;
+        std::mutex error_mutex;
+
+        auto open = [this, &next, &error, &error_mutex] {
+            for (size_t idx = next++; idx < m_options.min_size; idx = next++) {
+                try {
+                    push_idle(session_type::connect(m_conn_string));
+                    ++m_total;
+                } catch (...) {
+                    std::lock_guard lock(error_mutex);
+                    error = std::current_exception();
+                }
+            }
+        };
+
+        const size_t threads_number = std::min<size_t>(m_options.min_size, std::max(1u, std::thread::hardware_concurrency()));
+        std::vector<std::jthread> threads;
+        for (size_t idx = 1; idx < threads_number; ++idx) {
+            threads.emplace_back(open);
+        }
+        open();
+        threads.clear();
+
+        if (error) {
+            while (pop_idle()) {
+            }
+            std::rethrow_exception(error);
+        }
+    }
+
+    session_ptr_type acquire()
+    {
+        if (m_options.thread_affinity) {
+            if (session_ptr_type session = take(local_slot()))
+                return session;
+        }
+
+        if (session_ptr_type session = pop_idle())
+            return session;
+
+        if (m_options.thread_affinity) {
+            std::lock_guard lock(m_mutex);
+            if (session_ptr_type session = steal())
+                return session;
+        }
+
+        return grow();
+    }
+
+    /*! \fn session_ptr_type grow()
+     *  \brief Opens a new session if the pool is under max_size
+     *  \return The session opened; nullptr if the pool is full or the session can not be opened
+     */
+    session_ptr_type grow()
+    {
+        size_t total = m_total.load();
+        do {
+            if (total >= m_options.max_size)
+                return {};
+        } while (not m_total.compare_exchange_weak(total, total + 1));
+
+        try {
+            session_ptr_type session = session_type::connect(m_conn_string);
+            m_grown.fetch_add(1, std::memory_order_relaxed);
+            return session;
+        } catch (...) {
+            m_total.fetch_sub(1);
+            return {};
+        }
+    }
+
+    session_proxy make_proxy(session_ptr_type session, clock_type::time_point started)
+    {
+        const auto acquired = clock_type::now();
+        m_wait_histogram.record(acquired - started);
+
+        const size_t checked_out = m_checked_out.fetch_add(1, std::memory_order_relaxed) + 1;
+        size_t peak = m_peak_checked_out.load(std::memory_order_relaxed);
+        while (peak < checked_out and not m_peak_checked_out.compare_exchange_weak(peak, checked_out, std::memory_order_relaxed)) {
+        }
+
+        return session_proxy(this->weak_from_this(), std::move(session), acquired);
+    }
+
+    void check_in(session_ptr_type session, clock_type::time_point acquired)
+    {
+        if (not session)
+            return;
+
+        m_hold_histogram.record(clock_type::now() - acquired);
+        m_checked_out.fetch_sub(1, std::memory_order_relaxed);
+        release_session(std::move(session));
+    }
+
+    /*! \fn void call_sink(Func&& func)
+     *  \brief Calls the \a func with the installed sink if any, set_metrics_sink() waits for the call
+     */
+    template <class Func>
+    void call_sink(Func&& func)
+    {
+        // The users are counted before the sink is read: set_metrics_sink() either
+        // has the new sink read here or sees this call in progress
+        m_sink_users.fetch_add(1);
+        try {
+            if (metrics_sink* sink = m_sink.load())
+                std::forward<Func>(func)(*sink);
+        } catch (...) {
+            leave_sink();
+            throw;
+        }
+        leave_sink();
+    }
+
+    void leave_sink()
+    {
+        if (m_sink_users.fetch_sub(1) == 1)
+            m_sink_users.notify_all();
+    }
+
+    void notify_exhausted()
+    {
+        call_sink([this](metrics_sink& sink) {
+            sink.exhausted(*this);
+        });
+    }
+
+    /*! \fn session_ptr_type wait_session(clock_type::time_point deadline)
+     *  \brief Takes an idle session or waits for a release up to the \a deadline
+     *  \return A session; nullptr if the deadline has passed
+     */
+    session_ptr_type wait_session(clock_type::time_point deadline)
+    {
+        if (session_ptr_type session = acquire())
+            return session;
+
+        std::unique_lock lock(m_mutex);
+
+        // Announce the waiter before the last look into the ring, a concurrent release
+        // either is seen here or sees the waiter and hands the session over
+        m_waiting.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        session_ptr_type session = pop_or_steal();
+        if (not session) {
+            // A session discarded meanwhile either is replaced here or by the discarding thread
+            session = grow();
+        }
+        if (session) {
+            m_waiting.fetch_sub(1);
+            return session;
+        }
+
+        m_dry.fetch_add(1, std::memory_order_relaxed);
+        ++m_waits;
+
+        const auto started = clock_type::now();
+
+        waiter node;
+        m_waiters.push_back(node);
+        m_available.wait_until(lock, deadline, [&node] {
+            return node.session != nullptr;
+        });
+        m_wait_time += clock_type::now() - started;
+        m_waiting.fetch_sub(1);
+
+        if (not node.session) {
+            m_waiters.erase(node);
+            ++m_timeouts;
+        }
+        lock.unlock();
+
+        // The sink is called without the lock, the releasers are not held up by it
+        notify_exhausted();
+        return std::move(node.session);
+    }
+
+    bool healthy(session_raw_type& session) const
+    {
+        if (not session.is_connected())
+            return false;
+        if (m_options.probe.empty())
+            return true;
+
+        try {
+            session << m_options.probe;
+            return true;
+        } catch (...) {
+            return false;
+        }
+    }
+
+    /*! \fn bool check_out(session_ptr_type& session)
+     *  \brief Validates the \a session being handed out if required, a broken one is discarded
+     */
+    bool check_out(session_ptr_type& session)
+    {
+        if (not m_options.validate_on_borrow or healthy(*session))
+            return true;
+
+        discard(std::move(session));
+        return false;
+    }
+
+    /*! \fn void discard(session_ptr_type session)
+     *  \brief Closes a broken \a session and wakes the maintenance up to replace it
+     *
+     *  Without the maintenance the replacement is opened by the next checkout, or at once for the waiters.
+     */
+    void discard(session_ptr_type session)
+    {
+        session.reset();
+        m_total.fetch_sub(1);
+        m_broken.fetch_add(1, std::memory_order_relaxed);
+
+        bool maintained = false;
+        {
+            std::lock_guard lock(m_mutex);
+            m_replenish = true;
+            maintained = m_maintenance.joinable();
+        }
+        if (maintained) {
+            m_maintenance_wakeup.notify_one();
+            return;
+        }
+
+        if (m_waiting.load() > 0) {
+            if (session_ptr_type replacement = grow()) {
+                std::lock_guard lock(m_mutex);
+                hand_over(std::move(replacement));
+            }
+        }
+    }
+
+    /*! \fn void start_maintenance()
+     *  \brief Starts the maintenance thread unless it runs
+     */
+    void start_maintenance()
+    {
+        std::lock_guard lock(m_mutex);
+        if (not m_maintenance.joinable()) {
+            m_maintenance = std::jthread([this](std::stop_token stop) {
+                maintain(stop);
+            });
+        }
+    }
+
+    /*! \fn void maintain(std::stop_token stop)
+     *  \brief Closes the sessions idle for longer than idle_ttl and replaces the broken ones, keeps min_size sessions open
+     */
+    void maintain(std::stop_token stop)
+    {
+        auto period = std::max<clock_type::duration>(m_options.maintenance_interval, std::chrono::milliseconds { 1 });
+        if (m_options.idle_ttl.count() > 0)
+            period = std::min<clock_type::duration>(period, std::max<clock_type::duration>(m_options.idle_ttl / 2, std::chrono::milliseconds { 1 }));
+
+        std::unique_lock lock(m_mutex);
+        for (;;) {
+            m_maintenance_wakeup.wait_for(lock, stop, period, [this] { return m_replenish; });
+            if (stop.stop_requested())
+                return;
+            m_replenish = false;
+            lock.unlock();
+
+            if (m_options.idle_ttl.count() > 0 and m_options.max_size > m_options.min_size)
+                reap();
+            replenish(stop);
+
+            call_sink([this](metrics_sink& sink) {
+                sink.report(metrics());
+            });
+
+            // A waiter might have missed the sessions held by the maintenance
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            lock.lock();
+            if (m_waiting.load() > 0)
+                hand_over({});
+        }
+    }
+
+    void reap()
+    {
+        const auto now = clock_type::now();
+        for (size_t count = m_idle.size(); count > 0; --count) {
+            idle_entry entry;
+            if (not m_idle.try_pop(entry))
+                break;
+
+            const bool expired = now - entry.released >= m_options.idle_ttl;
+            if (expired and shrink()) {
+                session_ptr_type(entry.session);
+                m_reaped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            push_entry(entry);
+            if (not expired)
+                break;
+        }
+    }
+
+    /*! \fn void replenish(std::stop_token stop)
+     *  \brief Opens the sessions up to min_size, the failed connections are retried on the next maintenance
+     */
+    void replenish(std::stop_token stop)
+    {
+        while (not stop.stop_requested()) {
+            size_t total = m_total.load();
+            do {
+                if (total >= m_options.min_size)
+                    return;
+            } while (not m_total.compare_exchange_weak(total, total + 1));
+
+            try {
+                session_ptr_type session = session_type::connect(m_conn_string);
+                m_reconnects.fetch_add(1, std::memory_order_relaxed);
+                release_shared(std::move(session));
+            } catch (...) {
+                m_total.fetch_sub(1);
+                m_reconnect_failures.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+
+    bool shrink()
+    {
+        size_t total = m_total.load();
+        do {
+            if (total <= m_options.min_size)
+                return false;
+        } while (not m_total.compare_exchange_weak(total, total - 1));
+        return true;
+    }
+
+    /*! \fn session_ptr_type pop_or_steal()
+     *  \brief Takes an idle session from the ring or from a thread slot, the mutex is held by the caller
+     */
+    session_ptr_type pop_or_steal()
+    {
+        if (session_ptr_type session = pop_idle())
+            return session;
+        return m_options.thread_affinity ? steal() : session_ptr_type {};
+    }
+
+    session_ptr_type steal()
+    {
+        for (const auto& slot : m_slots) {
+            if (session_ptr_type session = take(*slot))
+                return session;
+        }
+        return {};
+    }
+
+    static thread_slots& local_slots()
+    {
+        static thread_local thread_slots slots;
+        return slots;
+    }
+
+    affine_slot& local_slot()
+    {
+        return local_slots().get(*this);
+    }
+
+    affine_slot* find_local_slot() const noexcept
+    {
+        return local_slots().find(*this);
+    }
+
+    bool keep(affine_slot& slot, session_ptr_type& session)
+    {
+        session_raw_type* expected = nullptr;
+        m_cached.fetch_add(1, std::memory_order_relaxed);
+        if (not slot.session.compare_exchange_strong(expected, session.get())) {
+            m_cached.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+        session.release();
+        return true;
+    }
+
+    session_ptr_type take(affine_slot& slot)
+    {
+        if (slot.session.load(std::memory_order_relaxed) == nullptr)
+            return {};
+
+        session_ptr_type session(slot.session.exchange(nullptr));
+        if (session)
+            m_cached.fetch_sub(1, std::memory_order_relaxed);
+        return session;
+    }
+
+    void attach(const affine_slot_ptr& slot)
+    {
+        std::lock_guard lock(m_mutex);
+        m_slots.push_back(slot);
+    }
+
+    void detach(const affine_slot_ptr& slot)
+    {
+        session_ptr_type session;
+        {
+            std::lock_guard lock(m_mutex);
+            std::erase(m_slots, slot);
+            session = take(*slot);
+        }
+        if (session)
+            release_shared(std::move(session));
+    }
+
+    void release_shared(session_ptr_type session)
+    {
+        if (m_waiting.load() == 0) {
+            push_idle(std::move(session));
+
+            // A waiter might have come after the check, it has to get a session from the ring
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_waiting.load() == 0)
+                return;
+        }
+
+        std::lock_guard lock(m_mutex);
+        hand_over(std::move(session));
+    }
+
+    /*! \fn void hand_over(session_ptr_type session)
+     *  \brief Hands the \a session (or the idle ones if none) over to the waiters, the mutex is held by the caller
+     */
+    void hand_over(session_ptr_type session)
+    {
+        if (session) {
+            if (waiter* node = m_waiters.pop_front()) {
+                node->session = std::move(session);
+                m_available.notify_all();
+            } else {
+                push_idle(std::move(session));
+            }
+            return;
+        }
+
+        while (not m_waiters.empty()) {
+            session_ptr_type idle = pop_or_steal();
+            if (not idle)
+                break;
+            m_waiters.pop_front()->session = std::move(idle);
+            m_available.notify_all();
+        }
+    }
+
+    session_ptr_type pop_idle()
+    {
+        idle_entry entry;
+        m_idle.try_pop(entry);
+        return session_ptr_type(entry.session);
+    }
+
+    void push_idle(session_ptr_type session)
+    {
+        idle_entry entry { .session = session.release() };
+        if (m_options.idle_ttl.count() > 0)
+            entry.released = clock_type::now();
+        push_entry(entry);
+    }
+
+    void push_entry(const idle_entry& entry)
     {
-        for (size_t idx = 0; idx < size; ++idx) {
-            auto session = session_type::connect(conn_string);
-            m_idle.emplace_back(std::move(session));
+        // Every session of the pool fits in the ring; a push fails only for the moment
+        // a concurrent pop of the same cell is not completed yet
+        while (not m_idle.try_push(entry)) {
+            std::this_thread::yield();
         }
     }
 
+    const std::string m_conn_string;
+    const options_type m_options;
     session_cont_type m_idle;
+    std::atomic<size_t> m_total;
+    std::atomic<size_t> m_waiting;
+    std::atomic<size_t> m_dry;
+    std::atomic<size_t> m_grown;
+    std::atomic<size_t> m_reaped;
+    std::atomic<size_t> m_broken;
+    std::atomic<size_t> m_reconnects;
+    std::atomic<size_t> m_reconnect_failures;
+    std::atomic<size_t> m_cached;
+    std::atomic<size_t> m_checked_out;
+    std::atomic<size_t> m_peak_checked_out;
+    base::log2_histogram m_wait_histogram;
+    base::log2_histogram m_hold_histogram;
+    std::atomic<metrics_sink*> m_sink;
+    std::atomic<size_t> m_sink_users;
+    std::vector<affine_slot_ptr> m_slots;
+    waiters_list m_waiters;
+    size_t m_waits;
+    size_t m_timeouts;
+    clock_type::duration m_wait_time;
     mutable mutex_type m_mutex;
+    std::condition_variable m_available;
+    bool m_replenish;
+    std::condition_variable_any m_maintenance_wakeup;
+    std::jthread m_maintenance;
 };
 
 } // namespace soci_wrapper
@@ -1,11 +1,16 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <concepts>
 #include <cstdint>
 #include <string>
 #include <string_view>
+#include <tuple>
 #include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
 
 #include "base/meta_data.hpp"
 #include "base/utility.hpp"
@@ -154,103 +159,629 @@ struct to_ind<std::string> {
     }
 };
 
-} // namespace soci_wrapper
+namespace details {
 
-namespace soci {
+    /*! \fn constexpr auto& member_at(Type& object)
+     *  \brief Returns a reference to the \a Idx -th declared member of the \a object
+     */
+    template <size_t Idx, class Type>
+    constexpr auto& member_at(Type& object)
+    {
+        return object.*std::get<Idx>(type_meta_data<std::remove_const_t<Type>>::member_pointers());
+    }
 
-template <class Type>
-    requires soci_wrapper::details::type_meta_data<Type>::is_declared::value
-struct type_conversion<Type> {
-    using base_type = values;
+    /*! \brief The DB column types of a persistent type in the declaration order
+     */
+    template <class Type, class Tuple = typename type_meta_data<Type>::tuple_type>
+    struct db_types;
 
-    using object_type = Type;
+    template <class Type, class... Types>
+    struct db_types<Type, std::tuple<Types...>> {
+        static constexpr std::array<std::string_view, sizeof...(Types)> value { cpp_to_db_type<Types>::db_type... };
+    };
 
-    using type_meta_data = soci_wrapper::details::type_meta_data<object_type>;
+    struct sql_length {
+        constexpr void operator()(std::string_view v)
+        {
+            size += v.size();
+        }
 
-    static void from_base(const base_type& v, indicator ind, Type& object)
-    {
-        soci_wrapper::base::tuple_for_each(
-            type_meta_data::types_pair(),
-            from_base_obj(v, ind, object));
-    }
+        size_t size { 0 };
+    };
 
-    static void to_base(const Type& object, base_type& v, indicator& ind)
-    {
-        soci_wrapper::base::tuple_for_each(
-            type_meta_data::types_pair(),
-            to_base_obj(object, v, ind));
-    }
+    template <size_t N>
+    struct sql_writer {
+        constexpr void operator()(std::string_view v)
+        {
+            for (auto c : v) {
+                arr[pos++] = c;
+            }
+        }
 
-private:
-    struct from_base_obj {
-        from_base_obj(const base_type& v, indicator& i, Type& obj)
-            : values(v)
-            , ind(i)
-            , object(obj)
+        std::array<char, N> arr {};
+        size_t pos { 0 };
+    };
+
+    /*! \brief Concatenates at compile time the strings written by Builder::write(writer)
+     */
+    template <class Builder>
+    struct compose_s {
+        static constexpr size_t size = [] {
+            sql_length length {};
+            Builder::write(length);
+            return length.size;
+        }();
+
+        static constexpr auto impl() noexcept -> std::array<char, size>
+        {
+            sql_writer<size> writer {};
+            Builder::write(writer);
+            return writer.arr;
+        }
+
+        static constexpr decltype(impl()) arr = impl();
+
+        static constexpr std::string_view value { arr.data(), arr.size() };
+    };
+
+    template <class Type>
+    struct insert_values_sql_builder {
+        template <class Writer>
+        static constexpr void write(Writer& w)
+        {
+            constexpr const auto& names = type_meta_data<Type>::member_names();
+
+            w("INSERT INTO ");
+            w(type_meta_data<Type>::table_name());
+            w(" (");
+            for (size_t idx = 0; idx < names.size(); ++idx) {
+                w(idx ? "," : "");
+                w(names[idx]);
+            }
+            w(") VALUES ");
+        }
+    };
+
+    template <class Type>
+    struct insert_sql_builder {
+        template <class Writer>
+        static constexpr void write(Writer& w)
+        {
+            constexpr const auto& names = type_meta_data<Type>::member_names();
+
+            insert_values_sql_builder<Type>::write(w);
+            w("(");
+            for (size_t idx = 0; idx < names.size(); ++idx) {
+                w(idx ? ",:" : ":");
+                w(names[idx]);
+            }
+            w(")");
+        }
+    };
+
+    template <class Type>
+    struct select_sql_builder {
+        template <class Writer>
+        static constexpr void write(Writer& w)
+        {
+            constexpr const auto& names = type_meta_data<Type>::member_names();
+
+            w("SELECT ");
+            for (size_t idx = 0; idx < names.size(); ++idx) {
+                w(idx ? "," : "");
+                w(names[idx]);
+            }
+            w(" FROM ");
+            w(type_meta_data<Type>::table_name());
+        }
+    };
+
+    /*! \brief The SELECT of the members Idx... of a persistent type, see query::from::select()
+     */
+    template <class Type, size_t... Idx>
+    struct select_fields_sql_builder {
+        template <class Writer>
+        static constexpr void write(Writer& w)
+        {
+            constexpr const auto& names = type_meta_data<Type>::member_names();
+            constexpr std::array<size_t, sizeof...(Idx)> fields { Idx... };
+
+            w("SELECT ");
+            for (size_t idx = 0; idx < fields.size(); ++idx) {
+                w(idx ? "," : "");
+                w(names[fields[idx]]);
+            }
+            w(" FROM ");
+            w(type_meta_data<Type>::table_name());
+        }
+    };
+
+    template <class Type>
+    struct count_sql_builder {
+        template <class Writer>
+        static constexpr void write(Writer& w)
+        {
+            w("SELECT COUNT(*) FROM ");
+            w(type_meta_data<Type>::table_name());
+        }
+    };
+
+    template <class Type>
+    struct create_sql_builder {
+        template <class Writer>
+        static constexpr void write(Writer& w)
+        {
+            w("CREATE TABLE IF NOT EXISTS ");
+            w(type_meta_data<Type>::table_name());
+            w(" (");
+        }
+    };
+
+    template <class Type>
+    struct drop_sql_builder {
+        template <class Writer>
+        static constexpr void write(Writer& w)
+        {
+            w("DROP TABLE IF EXISTS ");
+            w(type_meta_data<Type>::table_name());
+        }
+    };
+
+    /*! \brief The SQL statements of a persistent type generated at compile time
+     *
+     *  The runtime paths only append the dynamic parts, e.g. WHERE, ORDER BY and the table constraints.
+     */
+    template <class Type>
+    struct sql_text {
+        static constexpr std::string_view insert = compose_s<insert_sql_builder<Type>>::value;
+
+        static constexpr std::string_view insert_values = compose_s<insert_values_sql_builder<Type>>::value;
+
+        static constexpr std::string_view select = compose_s<select_sql_builder<Type>>::value;
+
+        static constexpr std::string_view count = compose_s<count_sql_builder<Type>>::value;
+
+        static constexpr std::string_view create = compose_s<create_sql_builder<Type>>::value;
+
+        static constexpr std::string_view drop = compose_s<drop_sql_builder<Type>>::value;
+    };
+
+    template <class Tuple>
+    struct columns_of;
+
+    template <class... Types>
+    struct columns_of<std::tuple<Types...>> {
+        using type = std::tuple<std::vector<cpp_to_soci_type_t<Types>>...>;
+    };
+
+    /*! \brief Column-wise buffers of a persistent type
+     *
+     *  Holds one vector per declared member (converted onto the SOCI type) and the related indicators.
+     *  The buffers are bound once to a statement and refilled chunk by chunk, keeping the capacity;
+     *  either as the values written (bind(), bind_rows()) or as the values fetched (bind_into()).
+     */
+    template <class Type>
+    struct column_buffers {
+        using self_type = column_buffers<Type>;
+
+        using type_meta_data = details::type_meta_data<Type>;
+
+        using tuple_type = typename type_meta_data::tuple_type;
+
+        using fields_number = typename type_meta_data::fields_number;
+
+        using columns_type = typename columns_of<tuple_type>::type;
+
+        using indicators_type = std::array<std::vector<soci::indicator>, fields_number::value>;
+
+        column_buffers()
+            : columns {}
+            , indicators {}
+            , m_auto_increment(configuration<Type>::auto_increment_flags())
+        {
+        }
+
+        void reserve(size_t size)
+        {
+            for_each_column([size](auto& column, auto& indicators) {
+                column.reserve(size);
+                indicators.reserve(size);
+            });
+        }
+
+        void clear()
+        {
+            for_each_column([](auto& column, auto& indicators) {
+                column.clear();
+                indicators.clear();
+            });
+        }
+
+        /*! \fn void resize(size_t size)
+         *  \brief Resizes the columns, the size is the number of the rows requested by the next fetch
+         */
+        void resize(size_t size)
+        {
+            for_each_column([size](auto& column, auto& indicators) {
+                column.resize(size);
+                indicators.resize(size);
+            });
+        }
+
+        size_t size() const
+        {
+            return std::get<0>(columns).size();
+        }
+
+        void push_back(const Type& object)
+        {
+            push_back(object, std::make_index_sequence<fields_number::value> {});
+        }
+
+        void bind(soci::statement& statement)
+        {
+            bind(statement, std::make_index_sequence<fields_number::value> {});
+        }
+
+        /*! \fn void bind_into(soci::statement& statement)
+         *  \brief Binds the columns as the vectors of the fetched values, a fetch fills up to size() rows
+         */
+        void bind_into(soci::statement& statement)
+        {
+            bind_into(statement, std::make_index_sequence<fields_number::value> {});
+        }
+
+        /*! \fn void move_to(size_t row, Type& object)
+         *  \brief Moves the fetched \a row out of the columns into the \a object
+         */
+        void move_to(size_t row, Type& object)
+        {
+            move_to(row, object, std::make_index_sequence<fields_number::value> {});
+        }
+
+        /*! \fn void bind_rows(soci::statement& statement)
+         *  \brief Binds every buffered value by position, row by row
+         */
+        void bind_rows(soci::statement& statement)
         {
+            for (size_t row = 0; row < size(); ++row) {
+                bind_row(statement, row, std::make_index_sequence<fields_number::value> {});
+            }
         }
 
-        template <class T>
-        void operator()(const T& val)
+        columns_type columns;
+        indicators_type indicators;
+
+    private:
+        template <class Func>
+        void for_each_column(Func&& func)
+        {
+            for_each_column(std::forward<Func>(func), std::make_index_sequence<fields_number::value> {});
+        }
+
+        template <class Func, size_t... Idx>
+        void for_each_column(Func&& func, std::index_sequence<Idx...>)
         {
-            using cpp_type = std::remove_pointer_t<decltype(val.first)>;
-            using soci_type = soci_wrapper::cpp_to_soci_type_t<cpp_type>;
+            (func(std::get<Idx>(columns), indicators[Idx]), ...);
+        }
 
-            const size_t field_offset = type_meta_data::field_offset(val.second);
+        template <size_t... Idx>
+        void bind(soci::statement& statement, std::index_sequence<Idx...>)
+        {
+            (statement.exchange(soci::use(std::get<Idx>(columns), indicators[Idx],
+                 std::string { type_meta_data::member_names()[Idx] })),
+                ...);
+        }
 
-            cpp_type* value = reinterpret_cast<cpp_type*>(
-                reinterpret_cast<size_t>(&object) + field_offset);
+        template <size_t... Idx>
+        void bind_into(soci::statement& statement, std::index_sequence<Idx...>)
+        {
+            (statement.exchange(soci::into(std::get<Idx>(columns), indicators[Idx])), ...);
+        }
+
+        template <size_t... Idx>
+        void move_to(size_t row, Type& object, std::index_sequence<Idx...>)
+        {
+            (move_field<Idx>(row, object), ...);
+        }
+
+        template <size_t Idx>
+        void move_field(size_t row, Type& object)
+        {
+            using cpp_type = std::tuple_element_t<Idx, tuple_type>;
+
+            auto& value = member_at<Idx>(object);
+            auto& src = std::get<Idx>(columns)[row];
+            if constexpr (not treat_as_array_v<cpp_type>) {
+                if (indicators[Idx][row] == soci::i_null)
+                    value = cpp_type {};
+                else
+                    value = std::move(src);
+            } else {
+                std::fill(std::begin(value), std::end(value), '\0');
+                if (indicators[Idx][row] != soci::i_null)
+                    std::copy_n(src.begin(), std::min(src.size(), std::size(value)), std::begin(value));
+            }
+        }
 
-            auto&& src = values.get<soci_type>(val.second, soci_type {});
-            if constexpr (not ::soci_wrapper::details::treat_as_array_v<cpp_type>)
-                *value = std::move(src);
+        template <size_t... Idx>
+        void bind_row(soci::statement& statement, size_t row, std::index_sequence<Idx...>)
+        {
+            (statement.exchange(soci::use(std::get<Idx>(columns)[row], indicators[Idx][row])), ...);
+        }
+
+        template <size_t... Idx>
+        void push_back(const Type& object, std::index_sequence<Idx...>)
+        {
+            (push_field<Idx>(object), ...);
+        }
+
+        template <size_t Idx>
+        void push_field(const Type& object)
+        {
+            using cpp_type = std::tuple_element_t<Idx, tuple_type>;
+
+            const cpp_type& value = member_at<Idx>(object);
+
+            // NOTE: the autoincremented fields are replaced by NULL, see to_base()
+            indicators[Idx].emplace_back(m_auto_increment[Idx]
+                    ? soci::i_null
+                    : to_ind<cpp_type>::get_ind(value));
+
+            if constexpr (not treat_as_array_v<cpp_type>)
+                std::get<Idx>(columns).emplace_back(value);
             else
-                std::copy(std::begin(src), std::end(src), std::begin(*value));
+                std::get<Idx>(columns).emplace_back(value.data());
         }
 
-        const base_type& values;
-        indicator& ind;
-        Type& object;
+        std::array<bool, fields_number::value> m_auto_increment;
+    };
+
+    /*! \brief Column-wise buffers of the members Idx... of a persistent type, filled by the fetches
+     *
+     *  The counterpart of column_buffers::bind_into() for a subset of the members, see query::projection.
+     */
+    template <class Type, size_t... Idx>
+    struct projection_buffers {
+        using tuple_type = typename type_meta_data<Type>::tuple_type;
+
+        using values_type = std::tuple<std::tuple_element_t<Idx, tuple_type>...>;
+
+        using columns_type = std::tuple<std::vector<cpp_to_soci_type_t<std::tuple_element_t<Idx, tuple_type>>>...>;
+
+        using indicators_type = std::array<std::vector<soci::indicator>, sizeof...(Idx)>;
+
+        projection_buffers()
+            : columns {}
+            , indicators {}
+        {
+        }
+
+        void resize(size_t size)
+        {
+            resize(size, std::index_sequence_for<std::integral_constant<size_t, Idx>...> {});
+        }
+
+        size_t size() const
+        {
+            return std::get<0>(columns).size();
+        }
+
+        void bind_into(soci::statement& statement)
+        {
+            bind_into(statement, std::index_sequence_for<std::integral_constant<size_t, Idx>...> {});
+        }
+
+        /*! \fn auto take(size_t row)
+         *  \brief Moves the value of the \a row out of the Pos-th selected column, NULL gives the default value
+         */
+        template <size_t Pos>
+        std::tuple_element_t<Pos, values_type> take(size_t row)
+        {
+            using value_type = std::tuple_element_t<Pos, values_type>;
+
+            auto& src = std::get<Pos>(columns)[row];
+            const bool null = indicators[Pos][row] == soci::i_null;
+            if constexpr (not treat_as_array_v<value_type>) {
+                return null ? value_type {} : value_type { std::move(src) };
+            } else {
+                value_type ret {};
+                if (not null)
+                    std::copy_n(src.begin(), std::min(src.size(), ret.size()), ret.begin());
+                return ret;
+            }
+        }
+
+        columns_type columns;
+        indicators_type indicators;
+
+    private:
+        template <size_t... Pos>
+        void resize(size_t size, std::index_sequence<Pos...>)
+        {
+            ((std::get<Pos>(columns).resize(size), indicators[Pos].resize(size)), ...);
+        }
+
+        template <size_t... Pos>
+        void bind_into(soci::statement& statement, std::index_sequence<Pos...>)
+        {
+            (statement.exchange(soci::into(std::get<Pos>(columns), indicators[Pos])), ...);
+        }
+    };
+
+    template <class Type>
+    using into_staging_t = std::conditional_t<treat_as_array_v<Type>, std::string, std::monostate>;
+
+    template <class Tuple>
+    struct into_staging_of;
+
+    template <class... Types>
+    struct into_staging_of<std::tuple<Types...>> {
+        using type = std::tuple<into_staging_t<Types>...>;
     };
 
-    struct to_base_obj {
-        to_base_obj(const Type& obj, base_type& v, indicator& i)
-            : object(obj)
-            , values(v)
-            , ind(i)
+    /*! \brief Positional decoding of a persistent object
+     *
+     *  Binds every declared member of an object by soci::into in the declaration order, thus a row is decoded
+     *  straight into the object without soci::values and the lookups by name.
+     *  The char arrays are staged via std::string and copied by post_fetch().
+     */
+    template <class Type>
+    class row_into {
+    public:
+        using self_type = row_into<Type>;
+
+        using type_meta_data = details::type_meta_data<Type>;
+
+        using tuple_type = typename type_meta_data::tuple_type;
+
+        using fields_number = typename type_meta_data::fields_number;
+
+        explicit row_into(Type& object)
+            : m_object(object)
+            , m_staging {}
+            , m_indicators {}
         {
         }
 
-        template <class T>
-        soci::indicator operator()(const T& val)
+        row_into(const row_into&) = delete;
+
+        row_into& operator=(const row_into&) = delete;
+
+        void bind(soci::statement& statement)
         {
-            using cpp_type = std::remove_pointer_t<decltype(val.first)>;
-            const size_t field_offset = type_meta_data::field_offset(val.second);
+            bind(statement, std::make_index_sequence<fields_number::value> {});
+        }
 
-            cpp_type* value = reinterpret_cast<cpp_type*>(
-                reinterpret_cast<size_t>(&object) + field_offset);
+        /*! \fn void post_fetch()
+         *  \brief Completes the decoding of the fetched row, must be called after each fetch
+         */
+        void post_fetch()
+        {
+            post_fetch(std::make_index_sequence<fields_number::value> {});
+        }
 
-            // NOTE: if a field mark as an utoincremented
-            // then ignore the value and replace it by NULL
-            soci::indicator ind = soci_wrapper::configuration<object_type>::auto_increment()
-                                      .contains(val.second)
-                ? i_null
-                : soci_wrapper::to_ind<cpp_type>::get_ind(*value);
+    private:
+        template <size_t... Idx>
+        void bind(soci::statement& statement, std::index_sequence<Idx...>)
+        {
+            (bind_field<Idx>(statement), ...);
+        }
 
-            if constexpr (!::soci_wrapper::details::treat_as_array_v<cpp_type>)
-                values.set(val.second, *value, ind);
+        template <size_t Idx>
+        void bind_field(soci::statement& statement)
+        {
+            using cpp_type = std::tuple_element_t<Idx, tuple_type>;
+
+            if constexpr (not treat_as_array_v<cpp_type>)
+                statement.exchange(soci::into(member_at<Idx>(m_object), m_indicators[Idx]));
             else
-                // Convert data to std::string, the most suitable dt what offers by SOCI
-                // http://soci.sourceforge.net/doc/master/types/
-                values.set(val.second, std::string(value->data()), ind);
+                statement.exchange(soci::into(std::get<Idx>(m_staging), m_indicators[Idx]));
+        }
 
-            return ind;
+        template <size_t... Idx>
+        void post_fetch(std::index_sequence<Idx...>)
+        {
+            (post_fetch_field<Idx>(), ...);
+        }
+
+        template <size_t Idx>
+        void post_fetch_field()
+        {
+            using cpp_type = std::tuple_element_t<Idx, tuple_type>;
+
+            auto& value = member_at<Idx>(m_object);
+            if constexpr (not treat_as_array_v<cpp_type>) {
+                if (m_indicators[Idx] == soci::i_null)
+                    value = cpp_type {};
+            } else {
+                const std::string& src = std::get<Idx>(m_staging);
+                std::fill(std::begin(value), std::end(value), '\0');
+                if (m_indicators[Idx] != soci::i_null)
+                    std::copy_n(src.begin(), std::min(src.size(), std::size(value)), std::begin(value));
+            }
         }
 
-        const Type& object;
-        base_type& values;
-        indicator& ind;
+        Type& m_object;
+        typename into_staging_of<tuple_type>::type m_staging;
+        std::array<soci::indicator, fields_number::value> m_indicators;
     };
+
+} // namespace details
+
+} // namespace soci_wrapper
+
+namespace soci {
+
+template <class Type>
+    requires soci_wrapper::details::type_meta_data<Type>::is_declared::value
+struct type_conversion<Type> {
+    using base_type = values;
+
+    using object_type = Type;
+
+    using type_meta_data = soci_wrapper::details::type_meta_data<object_type>;
+
+    static void from_base(const base_type& v, indicator ind, Type& object)
+    {
+        from_base(v, ind, object, std::make_index_sequence<type_meta_data::fields_number::value> {});
+    }
+
+    static void to_base(const Type& object, base_type& v, indicator& ind)
+    {
+        to_base(object, v, ind, std::make_index_sequence<type_meta_data::fields_number::value> {});
+    }
+
+private:
+    template <size_t... Idx>
+    static void from_base(const base_type& v, [[maybe_unused]] indicator ind, Type& object, std::index_sequence<Idx...>)
+    {
+        (from_base_field<Idx>(v, object), ...);
+    }
+
+    template <size_t... Idx>
+    static void to_base(const Type& object, base_type& v, [[maybe_unused]] indicator& ind, std::index_sequence<Idx...>)
+    {
+        (to_base_field<Idx>(object, v), ...);
+    }
+
+    template <size_t Idx>
+    static void from_base_field(const base_type& values, Type& object)
+    {
+        using cpp_type = std::tuple_element_t<Idx, typename type_meta_data::tuple_type>;
+        using soci_type = soci_wrapper::cpp_to_soci_type_t<cpp_type>;
+
+        const std::string& name = std::get<Idx>(type_meta_data::types_pair()).second;
+        cpp_type& value = soci_wrapper::details::member_at<Idx>(object);
+
+        auto&& src = values.get<soci_type>(name, soci_type {});
+        if constexpr (not ::soci_wrapper::details::treat_as_array_v<cpp_type>)
+            value = std::move(src);
+        else
+            std::copy(std::begin(src), std::end(src), std::begin(value));
+    }
+
+    template <size_t Idx>
+    static void to_base_field(const Type& object, base_type& values)
+    {
+        using cpp_type = std::tuple_element_t<Idx, typename type_meta_data::tuple_type>;
+
+        const std::string& name = std::get<Idx>(type_meta_data::types_pair()).second;
+        const cpp_type& value = soci_wrapper::details::member_at<Idx>(object);
+
+        // NOTE: if a field mark as an utoincremented
+        // then ignore the value and replace it by NULL
+        soci::indicator ind = soci_wrapper::configuration<object_type>::auto_increment_flags()[Idx]
+            ? i_null
+            : soci_wrapper::to_ind<cpp_type>::get_ind(value);
+
+        if constexpr (!::soci_wrapper::details::treat_as_array_v<cpp_type>)
+            values.set(name, value, ind);
+        else
+            // Convert data to std::string, the most suitable dt what offers by SOCI
+            // http://soci.sourceforge.net/doc/master/types/
+            values.set(name, std::string(value.data()), ind);
+    }
 };
 
 } // namespace soci
@@ -0,0 +1,408 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/bounded_queue.hpp"
+#include "configuration.hpp"
+#include "dml.hpp"
+#include "session.hpp"
+
+namespace soci_wrapper {
+namespace details {
+
+    /*! \fn void append_key(std::string& key, const Value& value)
+     *  \brief Appends the binary image of a primary key member to the \a key
+     */
+    template <class Value>
+    void append_key(std::string& key, const Value& value)
+    {
+        if constexpr (std::is_same_v<Value, std::string>) {
+            const std::size_t size = value.size();
+            key.append(reinterpret_cast<const char*>(&size), sizeof(size));
+            key.append(value);
+        } else {
+            static_assert(std::is_trivially_copyable_v<Value>,
+                "A primary key member is neither a string nor trivially copyable");
+            key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+    }
+
+    /*! \fn bool is_key_member(size_t idx)
+     *  \brief Checks the \a idx-th member is a primary key one, the auto increment member is the primary key as well
+     */
+    template <class Type>
+    bool is_key_member(size_t idx)
+    {
+        return configuration<Type>::primary_key_flags()[idx] or configuration<Type>::auto_increment_flags()[idx];
+    }
+
+    /*! \fn bool has_primary_key()
+     *  \brief Checks a primary key of the Type is configured, i.e. by the constraints of ddl::create_table()
+     */
+    template <class Type>
+    bool has_primary_key()
+    {
+        for (size_t idx = 0; idx < type_meta_data<Type>::fields_number::value; ++idx) {
+            if (is_key_member<Type>(idx))
+                return true;
+        }
+        return false;
+    }
+
+    /*! \fn void primary_key_of(std::string& key, const Type& object)
+     *  \brief Renders the primary key members of the \a object into the \a key
+     */
+    template <class Type, size_t... Idx>
+    void primary_key_of(std::string& key, const Type& object, std::index_sequence<Idx...>)
+    {
+        key.clear();
+        ((is_key_member<Type>(Idx) ? append_key(key, member_at<Idx>(object)) : void()), ...);
+    }
+
+} // namespace details
+
+/*! \brief A policy of the write_behind queue
+ */
+struct write_behind_policy {
+    /*! \brief The number of the objects the queue holds before persist() blocks
+     */
+    std::size_t capacity = 4096;
+
+    /*! \brief The maximum number of the objects written by a single transaction
+     */
+    std::size_t rows = 1000;
+
+    /*! \brief The flush window, the time the first queued object waits for the others
+     */
+    std::chrono::milliseconds interval = std::chrono::milliseconds { 100 };
+
+    /*! \brief Keeps only the last write of a primary key within a flush window
+     *
+     *  Requires the primary key of the type to be configured, see write_behind.
+     */
+    bool coalesce = false;
+};
+
+/*! \brief An asynchronous write-behind queue of the persistent objects
+ *
+ *  The objects are taken from any number of threads by a bounded lock-free queue and written
+ *  by a dedicated thread which owns the session (e.g. a session_proxy of a pool). The thread
+ *  groups the objects into transactions of up to \a rows objects by the multi-row dml::persist().
+ *  A batch is written once it is full, once the flush window has elapsed or on flush().
+ *  When the queue is full, persist() blocks until the writer catches up (try_persist() does not).
+ *  A failed batch is rolled back and handed to the error handler together with the exception.
+ *  With coalescing enabled, the objects of the same primary key replace each other within
+ *  a batch; the key is read from the primary key (or auto increment) constraints of configuration<Type>.
+ *  Those are set by ddl::create_table() in the process, the queue refuses coalescing without them:
+ *  all the objects would share the empty key and collapse into one.
+ */
+template <class Type>
+class write_behind {
+public:
+    using self_type = write_behind<Type>;
+
+    using object_type = Type;
+
+    using clock_type = std::chrono::steady_clock;
+
+    using error_handler_type = std::function<void(std::exception_ptr, std::span<const Type>)>;
+
+    static_assert(details::type_meta_data<Type>::is_declared::value,
+        "The object being persisted was not declared");
+
+    /*! \fn write_behind(session_handle session, write_behind_policy policy, error_handler_type on_error)
+     *  \param session A session or an rvalue session_proxy which is used by the writer thread exclusively
+     *  \param policy The policy of the queue
+     *  \param on_error A handler called on the writer thread with the objects of a failed batch
+     *  \throw std::logic_error if coalescing is requested for a type without a configured primary key
+     */
+    explicit write_behind(session_handle session, write_behind_policy policy = {}, error_handler_type on_error = {})
+        : m_session(std::move(session))
+        , m_policy(policy)
+        , m_on_error(std::move(on_error))
+        , m_queue(policy.capacity)
+        , m_enqueued(0)
+        , m_taken(0)
+        , m_processed(0)
+        , m_flush_target(0)
+        , m_written(0)
+        , m_failed(0)
+        , m_coalesced(0)
+        , m_stalls(0)
+        , m_dequeued(0)
+        , m_blocked(0)
+        , m_stopping(false)
+        , m_sleeping(false)
+        , m_stopped(false)
+        , m_mutex()
+        , m_wakeup()
+        , m_done()
+        , m_writer()
+    {
+        assert(m_policy.rows > 0);
+        if (m_policy.coalesce and not details::has_primary_key<Type>())
+            throw std::logic_error("The write-behind coalescing requires a primary key");
+        m_writer = std::thread([this] { run(); });
+    }
+
+    write_behind(const write_behind&) = delete;
+
+    write_behind& operator=(const write_behind&) = delete;
+
+    /*! \brief Drains the queue and stops the writer
+     */
+    ~write_behind()
+    {
+        close();
+    }
+
+    /*! \fn void persist(Type object)
+     *  \brief Enqueues the \a object, blocks while the queue is full
+     */
+    void persist(Type object)
+    {
+        if (try_persist(std::move(object)))
+            return;
+
+        ++m_stalls;
+
+        // The writer notifies the dequeues while a producer is blocked: the counter is read
+        // before the attempt, a dequeue after the failed one changes it and ends the wait
+        m_blocked.fetch_add(1);
+        try {
+            for (;;) {
+                const std::size_t dequeued = m_dequeued.load();
+                if (try_persist(std::move(object)))
+                    break;
+                m_dequeued.wait(dequeued);
+            }
+        } catch (...) {
+            m_blocked.fetch_sub(1);
+            throw;
+        }
+        m_blocked.fetch_sub(1);
+    }
+
+    /*! \fn bool try_persist(Type&& object)
+     *  \brief Enqueues the \a object unless the queue is full
+     *  \return true if the object was enqueued; otherwise - false, the object is left untouched
+     */
+    bool try_persist(Type&& object)
+    {
+        if (m_stopping.load(std::memory_order_relaxed))
+            throw std::logic_error("The write-behind queue is closed");
+
+        if (not m_queue.try_push(std::move(object)))
+            return false;
+
+        m_enqueued.fetch_add(1);
+        if (m_sleeping.load())
+            wakeup();
+        return true;
+    }
+
+    bool try_persist(const Type& object)
+    {
+        return try_persist(Type { object });
+    }
+
+    /*! \fn void flush()
+     *  \brief Blocks until the objects enqueued before the call are written or reported as failed
+     */
+    void flush()
+    {
+        const std::size_t target = m_enqueued.load();
+
+        std::size_t current = m_flush_target.load();
+        while (current < target and not m_flush_target.compare_exchange_weak(current, target)) {
+        }
+        wakeup();
+
+        std::unique_lock lock(m_mutex);
+        m_done.wait(lock, [this, target] {
+            return m_processed.load() >= target or m_stopped;
+        });
+    }
+
+    /*! \fn void close()
+     *  \brief Drains the queue and stops the writer; no object may be enqueued concurrently or afterwards
+     */
+    void close()
+    {
+        if (not m_writer.joinable())
+            return;
+
+        m_stopping.store(true);
+        wakeup();
+        m_writer.join();
+    }
+
+    /*! \fn std::size_t pending() const
+     *  \brief Returns the number of the objects enqueued but not written yet
+     */
+    std::size_t pending() const
+    {
+        const std::size_t processed = m_processed.load();
+        const std::size_t enqueued = m_enqueued.load();
+        return enqueued > processed ? enqueued - processed : 0;
+    }
+
+    std::size_t written() const
+    {
+        return m_written.load(std::memory_order_relaxed);
+    }
+
+    std::size_t failed() const
+    {
+        return m_failed.load(std::memory_order_relaxed);
+    }
+
+    std::size_t coalesced() const
+    {
+        return m_coalesced.load(std::memory_order_relaxed);
+    }
+
+    /*! \fn std::size_t stalls() const
+     *  \brief Returns the number of the persist() calls blocked by the full queue
+     */
+    std::size_t stalls() const
+    {
+        return m_stalls.load(std::memory_order_relaxed);
+    }
+
+private:
+    void wakeup()
+    {
+        std::lock_guard lock(m_mutex);
+        m_wakeup.notify_one();
+    }
+
+    void run()
+    {
+        std::vector<Type> batch;
+        batch.reserve(m_policy.rows);
+
+        std::unordered_map<std::string, std::size_t> index;
+        std::string key;
+
+        clock_type::time_point deadline {};
+
+        for (;;) {
+            Type object;
+            if (m_queue.try_pop(object)) {
+                ++m_taken;
+                m_dequeued.fetch_add(1);
+                if (m_blocked.load() > 0)
+                    m_dequeued.notify_all();
+                if (batch.empty())
+                    deadline = clock_type::now() + m_policy.interval;
+
+                if (m_policy.coalesce) {
+                    details::primary_key_of(key, object,
+                        std::make_index_sequence<details::type_meta_data<Type>::fields_number::value> {});
+                    if (auto [it, inserted] = index.try_emplace(key, batch.size()); not inserted) {
+                        batch[it->second] = std::move(object);
+                        m_coalesced.fetch_add(1, std::memory_order_relaxed);
+                        continue;
+                    }
+                }
+
+                batch.emplace_back(std::move(object));
+                if (batch.size() >= m_policy.rows) {
+                    write(batch);
+                    index.clear();
+                }
+                continue;
+            }
+
+            const bool stopping = m_stopping.load();
+            if (not batch.empty()
+                and (stopping or m_flush_target.load() > m_processed.load() or clock_type::now() >= deadline)) {
+                write(batch);
+                index.clear();
+                continue;
+            }
+
+            if (stopping and m_taken >= m_enqueued.load())
+                break;
+
+            std::unique_lock lock(m_mutex);
+            m_sleeping.store(true);
+            if (m_taken >= m_enqueued.load() and not m_stopping.load()
+                and (batch.empty() or m_flush_target.load() <= m_processed.load())) {
+                if (batch.empty())
+                    m_wakeup.wait(lock);
+                else
+                    m_wakeup.wait_until(lock, deadline);
+            }
+            m_sleeping.store(false);
+        }
+
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopped = true;
+        }
+        m_done.notify_all();
+    }
+
+    void write(std::vector<Type>& batch)
+    {
+        try {
+            dml::persist(m_session.get(), batch);
+            m_written.fetch_add(batch.size(), std::memory_order_relaxed);
+        } catch (...) {
+            m_failed.fetch_add(batch.size(), std::memory_order_relaxed);
+            if (m_on_error) {
+                try {
+                    m_on_error(std::current_exception(), std::span<const Type>(batch));
+                } catch (...) {
+                }
+            }
+        }
+        batch.clear();
+
+        {
+            std::lock_guard lock(m_mutex);
+            m_processed.store(m_taken);
+        }
+        m_done.notify_all();
+    }
+
+    session_handle m_session;
+    const write_behind_policy m_policy;
+    const error_handler_type m_on_error;
+    base::bounded_queue<Type> m_queue;
+    std::atomic<std::size_t> m_enqueued;
+    std::size_t m_taken;
+    std::atomic<std::size_t> m_processed;
+    std::atomic<std::size_t> m_flush_target;
+    std::atomic<std::size_t> m_written;
+    std::atomic<std::size_t> m_failed;
+    std::atomic<std::size_t> m_coalesced;
+    std::atomic<std::size_t> m_stalls;
+    std::atomic<std::size_t> m_dequeued;
+    std::atomic<std::size_t> m_blocked;
+    std::atomic<bool> m_stopping;
+    std::atomic<bool> m_sleeping;
+    bool m_stopped;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::condition_variable m_done;
+    std::thread m_writer;
+};
+
+} // namespace soci_wrapper
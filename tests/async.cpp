@@ -0,0 +1,256 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE async
+
+#include "soci-wrapper.hpp"
+#include <atomic>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <coroutine>
+#include <functional>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(SW_SQLITE)
+constexpr bool sw_sqlite = true;
+#else
+constexpr bool sw_sqlite = false;
+#endif
+
+namespace sw = soci_wrapper;
+namespace utf = boost::unit_test;
+using sessions_pool = sw::sessions_pool<sw::session>;
+using session_raw_type = sessions_pool::session_raw_type;
+
+sessions_pool::ptr_type pool;
+
+struct async_tbl {
+    int id;
+    std::string name;
+};
+
+DECLARE_PERSISTENT_OBJECT(async_tbl,
+    id,
+    name);
+
+static const int requests_number = 100;
+
+// An eager coroutine reporting its result through a future
+template <class Type>
+struct task {
+    struct promise_type {
+        std::promise<Type> result;
+
+        task get_return_object()
+        {
+            return { result.get_future() };
+        }
+
+        std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_value(Type value)
+        {
+            result.set_value(std::move(value));
+        }
+
+        void unhandled_exception()
+        {
+            result.set_exception(std::current_exception());
+        }
+    };
+
+    std::future<Type> future;
+};
+
+task<int> persist_and_count(sw::async::executor& executor, int id)
+{
+    co_await sw::async::persist(executor, pool, async_tbl { .id = id, .name = "async" });
+    co_return co_await sw::async::count(executor, pool,
+        sw::dql::query_from<async_tbl>().where(sw::fields_query<async_tbl>::id == id));
+}
+
+task<std::vector<async_tbl>> select_range(int first, int last)
+{
+    co_return co_await sw::async::objects(pool,
+        sw::dql::query_from<async_tbl>()
+            .where(sw::fields_query<async_tbl>::id >= first && sw::fields_query<async_tbl>::id < last)
+            .orderByAsc(sw::fields_query<async_tbl>::id));
+}
+
+task<std::thread::id> resumed_on()
+{
+    co_await sw::async::run(pool, [](session_raw_type&) {
+    });
+    co_return std::this_thread::get_id();
+}
+
+task<int> exhausted(sw::async::executor& executor)
+{
+    co_return co_await sw::async::run(
+        executor, pool, [](session_raw_type&) {
+            return 0;
+        },
+        std::chrono::milliseconds { 10 });
+}
+
+task<int> failing()
+{
+    co_return co_await sw::async::run(pool, [](session_raw_type&) -> int {
+        throw std::runtime_error("failed job");
+    });
+}
+
+BOOST_AUTO_TEST_CASE(tst_batch_executor, *utf::depends_on("tst_async_persist"))
+{
+    sw::async::executor executor(4);
+    sw::batch_executor<sw::session> batch(pool, executor);
+
+    std::vector<std::future<int>> counts;
+    for (int id = 0; id < requests_number; ++id)
+        counts.push_back(batch.count(sw::dql::query_from<async_tbl>().where(sw::fields_query<async_tbl>::id == id)));
+    auto selected = batch.objects(sw::dql::query_from<async_tbl>().where(sw::fields_query<async_tbl>::id < 10));
+    BOOST_TEST(batch.size() == requests_number + 1);
+
+    batch.execute();
+    BOOST_TEST(batch.size() == 0);
+    for (auto& count : counts)
+        BOOST_TEST(count.get() == 1);
+    BOOST_TEST(selected.get().size() == 10);
+    BOOST_TEST(pool->size() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(tst_batch_run_all, *utf::depends_on("tst_conn"))
+{
+    sw::async::executor executor(4);
+
+    // The results follow the submission order whatever session and worker run the jobs
+    // The workers only count, Boost.Test is not thread-safe
+    std::atomic<int> disconnected = 0;
+    std::vector<std::function<int(session_raw_type&)>> jobs;
+    for (int idx = 0; idx < requests_number; ++idx) {
+        jobs.push_back([idx, &disconnected](session_raw_type& session) {
+            if (not session.is_connected())
+                ++disconnected;
+            return idx;
+        });
+    }
+    const auto results = sw::batch_executor<sw::session>::run_all(pool, jobs, executor);
+    BOOST_TEST(disconnected == 0);
+    BOOST_TEST(results.size() == requests_number);
+    for (int idx = 0; idx < static_cast<int>(results.size()); ++idx)
+        BOOST_TEST(results[idx] == idx);
+
+    jobs[requests_number / 2] = [](session_raw_type&) -> int {
+        throw std::runtime_error("failed job");
+    };
+    BOOST_CHECK_THROW(sw::batch_executor<sw::session>::run_all(pool, jobs, executor), std::runtime_error);
+    BOOST_TEST(pool->size() == 2);
+
+    // No runner gets a session in time, the futures of the jobs fail instead of hanging
+    {
+        auto first = pool->get_session();
+        auto second = pool->get_session();
+
+        sw::batch_executor<sw::session> batch(pool, executor, std::chrono::milliseconds { 10 });
+        auto counted = batch.count(sw::dql::query_from<async_tbl>());
+        batch.execute();
+        BOOST_CHECK_THROW(counted.get(), std::runtime_error);
+        BOOST_CHECK_THROW(sw::batch_executor<sw::session>::run_all(pool, jobs, executor, std::chrono::milliseconds { 10 }),
+            std::runtime_error);
+    }
+    BOOST_TEST(pool->size() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(tst_thread_pool)
+{
+    std::atomic<int> executed = 0;
+    {
+        sw::async::executor executor(4);
+
+        // The jobs posted by a worker are queued to the worker itself and stolen by the idle ones
+        std::promise<void> posted;
+        executor.post([&executor, &executed, &posted] {
+            for (int idx = 0; idx < requests_number; ++idx) {
+                executor.post([&executed] {
+                    std::this_thread::sleep_for(std::chrono::milliseconds { 1 });
+                    ++executed;
+                });
+            }
+            posted.set_value();
+        });
+        posted.get_future().wait();
+
+        while (executed < requests_number)
+            std::this_thread::yield();
+        BOOST_TEST(executor.steals() > 0);
+
+        // The queued jobs are executed before the workers are joined
+        for (int idx = 0; idx < requests_number; ++idx) {
+            executor.post([&executed] {
+                ++executed;
+            });
+        }
+    }
+    BOOST_TEST(executed == 2 * requests_number);
+}
+
+BOOST_AUTO_TEST_CASE(tst_async_error, *utf::depends_on("tst_async_objects"))
+{
+    BOOST_CHECK_THROW(failing().future.get(), std::runtime_error);
+    BOOST_TEST(pool->size() == 2);
+
+    // No session is released in time, the operation fails instead of holding the worker
+    sw::async::executor executor(1);
+    {
+        auto first = pool->get_session();
+        auto second = pool->get_session();
+        BOOST_CHECK_THROW(exhausted(executor).future.get(), std::runtime_error);
+    }
+    BOOST_TEST(exhausted(executor).future.get() == 0);
+    BOOST_TEST(pool->size() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(tst_async_objects, *utf::depends_on("tst_async_persist"))
+{
+    // The caller is not blocked, the coroutine is resumed by a worker
+    BOOST_TEST(resumed_on().future.get() != std::this_thread::get_id());
+
+    const auto objects = select_range(10, 20).future.get();
+    BOOST_TEST(objects.size() == 10);
+    for (int idx = 0; idx < static_cast<int>(objects.size()); ++idx) {
+        BOOST_TEST(objects[idx].id == 10 + idx);
+        BOOST_TEST(objects[idx].name == "async");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(tst_async_persist, *utf::depends_on("tst_conn"))
+{
+    // Many requests in flight share the two sessions of the pool
+    sw::async::executor executor(4);
+    std::vector<task<int>> requests;
+    for (int id = 0; id < requests_number; ++id)
+        requests.push_back(persist_and_count(executor, id));
+
+    for (auto& request : requests)
+        BOOST_TEST(request.future.get() == 1);
+    BOOST_TEST(pool->size() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(tst_conn, *utf::enable_if<sw_sqlite>())
+{
+    auto session = sw::session::connect("tst_object.db");
+    sw::ddl<async_tbl>::drop_table(*session);
+    sw::ddl<async_tbl>::create_table(*session,
+        sw::fields_query<async_tbl>::id = sw::primary_key_constraint);
+
+    pool = sessions_pool::create(2, "tst_object.db");
+}
@@ -0,0 +1,422 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE bench
+
+#include "soci-wrapper.hpp"
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <future>
+#include <ranges>
+#include <thread>
+
+#if defined(SW_SQLITE)
+constexpr bool sw_sqlite = true;
+#else
+constexpr bool sw_sqlite = false;
+#endif
+
+namespace sw = soci_wrapper;
+namespace utf = boost::unit_test;
+using sessions_pool = sw::sessions_pool<sw::session>;
+
+sw::session::session_ptr_type session;
+
+struct bench_tbl {
+    int id;
+    std::string name;
+};
+
+struct bench_decode_tbl {
+    int id;
+    double value;
+    std::string name;
+    std::string surname;
+    std::array<char, 8> code;
+};
+
+struct bench_page_tbl {
+    int id;
+    std::string name;
+};
+
+DECLARE_PERSISTENT_OBJECT(bench_tbl,
+    id,
+    name);
+
+DECLARE_PERSISTENT_OBJECT(bench_page_tbl,
+    id,
+    name);
+
+DECLARE_PERSISTENT_OBJECT(bench_decode_tbl,
+    id,
+    value,
+    name,
+    surname,
+    code);
+
+template <class Func>
+static double rows_per_second(size_t rows, Func&& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return rows / elapsed.count();
+}
+
+static std::vector<bench_tbl> make_rows(int first, int size)
+{
+    std::vector<bench_tbl> rows;
+    rows.reserve(size);
+    for (int idx = first; idx < first + size; ++idx) {
+        rows.push_back({ .id = idx, .name = "name " + std::to_string(idx) });
+    }
+    return rows;
+}
+
+BOOST_AUTO_TEST_CASE(tst_persist_vs_persist_bulk, *utf::depends_on("tst_conn"))
+{
+    const int size = 2000;
+
+    auto rows = make_rows(0, size);
+    const double single = rows_per_second(size, [&rows] {
+        for (const auto& row : rows)
+            sw::dml::persist(*session, row);
+    });
+
+    rows = make_rows(size, size);
+    const double bulk = rows_per_second(size, [&rows] {
+        sw::dml::persist_bulk(*session, rows);
+    });
+
+    BOOST_TEST_MESSAGE("persist: " << single << " rows/s, persist_bulk: " << bulk << " rows/s");
+    BOOST_TEST(sw::dql::query_from<bench_tbl>().count(*session) == 2 * size);
+}
+
+BOOST_AUTO_TEST_CASE(tst_insert_strategies, *utf::depends_on("tst_persist_vs_persist_bulk"))
+{
+    const int size = 2000;
+    int first = 100'000;
+
+    auto rows = make_rows(first, size);
+    const double single = rows_per_second(size, [&rows] {
+        for (const auto& row : rows)
+            sw::dml::persist(*session, row);
+    });
+
+    rows = make_rows(first += size, size);
+    const double single_batched = rows_per_second(size, [&rows] {
+        sw::dml::batch_writer<bench_tbl> writer(*session, { .rows = size });
+        for (const auto& row : rows)
+            writer.persist(row);
+    });
+
+    rows = make_rows(first += size, size);
+    const double vector_bound = rows_per_second(size, [&rows] {
+        sw::dml::persist_bulk(*session, rows);
+    });
+
+    rows = make_rows(first += size, size);
+    const double multi_row = rows_per_second(size, [&rows] {
+        sw::dml::persist(*session, rows);
+    });
+
+    BOOST_TEST_MESSAGE("single-row: " << single << " rows/s, "
+                                      << "single-row in a transaction: " << single_batched << " rows/s, "
+                                      << "vector-bound: " << vector_bound << " rows/s, "
+                                      << "multi-row VALUES: " << multi_row << " rows/s");
+}
+
+BOOST_AUTO_TEST_CASE(tst_decode_values_vs_positional, *utf::depends_on("tst_conn"))
+{
+    const int size = 1'000'000;
+
+    sw::dml::persist_bulk(*session, std::views::iota(0, size) | std::views::transform([](int idx) {
+        return bench_decode_tbl { .id = idx,
+            .value = idx * 0.5,
+            .name = "name " + std::to_string(idx),
+            .surname = "surname " + std::to_string(idx),
+            .code { "code" } };
+    }));
+
+    // soci::values: the members are looked up by name per row
+    std::vector<bench_decode_tbl> by_values;
+    by_values.reserve(size);
+    const double values = rows_per_second(size, [&by_values] {
+        bench_decode_tbl row {};
+        soci::statement st = (session->prepare << "SELECT id,value,name,surname,code FROM bench_decode_tbl",
+            soci::into(row));
+        st.execute();
+        while (st.fetch())
+            by_values.push_back(row);
+    });
+
+    // Positional soci::into per member
+    std::vector<bench_decode_tbl> by_position;
+    const double positional = rows_per_second(size, [&by_position] {
+        by_position = sw::dql::query_from<bench_decode_tbl>().objects(*session);
+    });
+
+    BOOST_TEST_MESSAGE("soci::values: " << values << " rows/s, positional: " << positional << " rows/s");
+    BOOST_TEST(by_values.size() == size);
+    BOOST_TEST(by_position.size() == size);
+    BOOST_TEST(by_position.back().surname == by_values.back().surname);
+    BOOST_TEST(by_position.back().code == by_values.back().code);
+}
+
+BOOST_AUTO_TEST_CASE(tst_bulk_fetch, *utf::depends_on("tst_decode_values_vs_positional"))
+{
+    const size_t size = sw::dql::query_from<bench_decode_tbl>().count(*session);
+
+    for (size_t fetch_size : { 1, 16, 256, 4096 }) {
+        std::vector<bench_decode_tbl> objects;
+        const double rate = rows_per_second(size, [&objects, fetch_size] {
+            objects = sw::dql::query_from<bench_decode_tbl>().objects(*session, fetch_size);
+        });
+        BOOST_TEST_MESSAGE("objects, fetch size " << fetch_size << ": " << rate << " rows/s");
+        BOOST_TEST(objects.size() == size);
+    }
+
+    // The columns are consumed as fetched, no object is built
+    double sum = 0;
+    const double rate = rows_per_second(size, [&sum] {
+        sw::dql::query_from<bench_decode_tbl>().for_each_chunk(*session, [&sum](auto& chunk) {
+            for (double value : std::get<1>(chunk.columns))
+                sum += value;
+        }, 4096);
+    });
+    BOOST_TEST_MESSAGE("columns, fetch size 4096: " << rate << " rows/s");
+    BOOST_TEST(sum == (size - 1) * size * 0.25);
+}
+
+BOOST_AUTO_TEST_CASE(tst_projection_scan, *utf::depends_on("tst_decode_values_vs_positional"))
+{
+    using fields = sw::fields_query<bench_decode_tbl>;
+
+    const size_t size = sw::dql::query_from<bench_decode_tbl>().count(*session);
+
+    std::vector<bench_decode_tbl> objects;
+    const double objects_rate = rows_per_second(size, [&objects] {
+        objects = sw::dql::query_from<bench_decode_tbl>().objects(*session, 4096);
+    });
+
+    // Neither read nor decoded: name, surname and code
+    std::vector<std::tuple<int, double>> tuples;
+    const double tuples_rate = rows_per_second(size, [&tuples] {
+        tuples = sw::dql::query_from<bench_decode_tbl>().select(fields::id, fields::value).tuples(*session, 4096);
+    });
+
+    BOOST_TEST_MESSAGE("all the columns: " << objects_rate << " rows/s, id and value: " << tuples_rate << " rows/s");
+    BOOST_TEST(tuples.size() == objects.size());
+    BOOST_TEST(std::get<1>(tuples.back()) == objects.back().value);
+}
+
+BOOST_AUTO_TEST_CASE(tst_columns_scan, *utf::depends_on("tst_decode_values_vs_positional"))
+{
+    const int passes = 20;
+
+    const auto objects = sw::dql::query_from<bench_decode_tbl>().objects(*session, 4096);
+    const auto rows = sw::dql::query_from<bench_decode_tbl>().columns(*session, 4096);
+    BOOST_TEST(rows.size() == objects.size());
+
+    // An array of the objects drags the strings through the cache, a column is contiguous
+    double by_objects = 0;
+    const double objects_rate = rows_per_second(objects.size() * passes, [&objects, &by_objects] {
+        for (int pass = 0; pass < passes; ++pass) {
+            for (const auto& object : objects)
+                by_objects += object.value;
+        }
+    });
+
+    double by_column = 0;
+    const std::vector<double>& values = rows[sw::fields_query<bench_decode_tbl>::value];
+    const double column_rate = rows_per_second(values.size() * passes, [&values, &by_column] {
+        for (int pass = 0; pass < passes; ++pass) {
+            for (double value : values)
+                by_column += value;
+        }
+    });
+
+    BOOST_TEST_MESSAGE("objects: " << objects_rate << " rows/s, columns: " << column_rate << " rows/s, strings: "
+                                   << rows.strings().used() << " bytes");
+    BOOST_TEST(by_column == by_objects);
+}
+
+BOOST_AUTO_TEST_CASE(tst_kernels_scan, *utf::depends_on("tst_conn"))
+{
+    namespace kernels = sw::kernels;
+
+    const size_t size = 10'000'000;
+    std::vector<double> values(size);
+    for (size_t idx = 0; idx < size; ++idx)
+        values[idx] = static_cast<double>(idx * 7919 % 1000);
+
+    // A naive loop with a branch per row, as a client side filter is usually written
+    double naive_sum = 0;
+    size_t naive_count = 0;
+    const double naive_rate = rows_per_second(size, [&values, &naive_sum, &naive_count] {
+        for (double value : values) {
+            if (value >= 500) {
+                naive_sum += value;
+                ++naive_count;
+            }
+        }
+    });
+
+    for (int isa = 0; isa <= static_cast<int>(kernels::supported_isa()); ++isa) {
+        kernels::select_isa(static_cast<kernels::isa>(isa));
+
+        // A mask, reusable for other predicates and columns, then the masked sum
+        double sum = 0;
+        size_t count = 0;
+        kernels::mask_type mask(size);
+        const double mask_rate = rows_per_second(size, [&values, &sum, &count, &mask] {
+            count = kernels::filter_mask(values, kernels::compare::greater_equal, 500.0, mask);
+            sum = kernels::sum(values, mask);
+        });
+        BOOST_TEST(count == naive_count);
+        BOOST_TEST(sum == naive_sum);
+
+        kernels::sum_count<double> fused {};
+        const double fused_rate = rows_per_second(size, [&values, &fused] {
+            fused = kernels::sum_if(values, kernels::compare::greater_equal, 500.0);
+        });
+        BOOST_TEST(fused.count == naive_count);
+        BOOST_TEST(fused.sum == naive_sum);
+
+        BOOST_TEST_MESSAGE("filter and sum, isa " << isa << ": naive " << naive_rate << " rows/s, mask "
+                                                  << mask_rate << " rows/s, fused " << fused_rate << " rows/s");
+    }
+    kernels::select_isa(kernels::supported_isa());
+}
+
+BOOST_AUTO_TEST_CASE(tst_keyset_vs_offset, *utf::depends_on("tst_conn"))
+{
+    using fields = sw::fields_query<bench_page_tbl>;
+
+    const int size = 200'000;
+    const size_t page_size = 100;
+
+    sw::dml::persist_bulk(*session, std::views::iota(0, size) | std::views::transform([](int idx) {
+        return bench_page_tbl { .id = idx, .name = "name " + std::to_string(idx) };
+    }));
+
+    // OFFSET reads and drops the preceding rows, the seek by the primary key does not
+    for (int depth : { 0, size / 2, size - static_cast<int>(page_size) }) {
+        std::vector<bench_page_tbl> by_offset;
+        const double offset_rate = rows_per_second(page_size, [&by_offset, depth] {
+            by_offset = sw::dql::query_from<bench_page_tbl>()
+                            .orderByAsc(fields::id)
+                            .limit(page_size, depth)
+                            .objects(*session);
+        });
+
+        std::vector<bench_page_tbl> by_key;
+        const double keyset_rate = rows_per_second(page_size, [&by_key, depth] {
+            by_key = sw::dql::query_from<bench_page_tbl>()
+                         .after(fields::id, depth - 1)
+                         .limit(page_size)
+                         .objects(*session);
+        });
+
+        BOOST_TEST_MESSAGE("page at " << depth << ", LIMIT/OFFSET: " << offset_rate << " rows/s, keyset: "
+                                      << keyset_rate << " rows/s");
+        BOOST_TEST(by_key.size() == page_size);
+        BOOST_TEST(by_key.front().id == by_offset.front().id);
+        BOOST_TEST(by_key.back().id == by_offset.back().id);
+    }
+
+    size_t rows = 0;
+    const double rate = rows_per_second(size, [&rows] {
+        for (const auto& page : sw::dql::query_from<bench_page_tbl>().pages(*session, fields::id, page_size))
+            rows += page.size();
+    });
+    BOOST_TEST_MESSAGE("all the pages: " << rate << " rows/s");
+    BOOST_TEST(rows == size);
+}
+
+BOOST_AUTO_TEST_CASE(tst_pool_contention, *utf::depends_on("tst_conn"))
+{
+    using namespace std::chrono_literals;
+
+    const size_t pool_size = 8;
+    const size_t cycles = 100'000;
+
+    for (bool thread_affinity : { false, true }) {
+        auto pool = sessions_pool::create(pool_size, "tst_object.db", thread_affinity);
+        for (size_t threads_number = 1; threads_number <= 128; threads_number *= 2) {
+            std::atomic<size_t> acquired = 0;
+            const double rate = rows_per_second(cycles, [&pool, &acquired, threads_number, cycles] {
+                std::vector<std::thread> threads;
+                for (size_t thread = 0; thread < threads_number; ++thread) {
+                    threads.emplace_back([&pool, &acquired, threads_number, cycles] {
+                        for (size_t cycle = 0; cycle < cycles / threads_number; ++cycle) {
+                            auto session = pool->get_session(10s);
+                            acquired += session.has_value();
+                        }
+                    });
+                }
+                for (auto& thread : threads)
+                    thread.join();
+            });
+
+            BOOST_TEST_MESSAGE((thread_affinity ? "thread-affine, " : "")
+                << threads_number << " threads: " << rate << " checkouts/s");
+            BOOST_TEST(acquired.load() == cycles / threads_number * threads_number);
+            BOOST_TEST(pool->size() == pool_size);
+        }
+
+        const auto statistics = pool->statistics();
+        BOOST_TEST_MESSAGE("dry: " << statistics.dry << ", waits: " << statistics.waits
+                                   << ", wait time: " << std::chrono::duration<double>(statistics.wait_time).count() << "s");
+        BOOST_TEST(statistics.timeouts == 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(tst_fan_out, *utf::depends_on("tst_persist_vs_persist_bulk"))
+{
+    const size_t requests = 1000;
+
+    const auto lookup = [](int id) {
+        return sw::dql::query_from<bench_tbl>().where(sw::fields_query<bench_tbl>::id == id);
+    };
+
+    const double sequential = rows_per_second(requests, [&lookup, requests] {
+        for (size_t request = 0; request < requests; ++request)
+            lookup(static_cast<int>(request)).count(*session);
+    });
+    BOOST_TEST_MESSAGE("sequential: " << sequential << " lookups/s");
+
+    sw::async::executor executor(8);
+    for (size_t pool_size = 1; pool_size <= 8; pool_size *= 2) {
+        auto pool = sessions_pool::create(pool_size, "tst_object.db");
+        size_t found = 0;
+        const double rate = rows_per_second(requests, [&pool, &executor, &lookup, &found, requests] {
+            sw::batch_executor<sw::session> batch(pool, executor);
+            std::vector<std::future<int>> counts;
+            for (size_t request = 0; request < requests; ++request)
+                counts.push_back(batch.count(lookup(static_cast<int>(request))));
+            batch.execute();
+            for (auto& count : counts)
+                found += count.get();
+        });
+
+        BOOST_TEST_MESSAGE(pool_size << " sessions: " << rate << " lookups/s");
+        BOOST_TEST(found == requests);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(tst_conn, *utf::enable_if<sw_sqlite>())
+{
+    session = sw::session::connect("tst_object.db");
+    BOOST_TEST(session->is_connected());
+
+    sw::ddl<bench_tbl>::drop_table(*session);
+    sw::ddl<bench_tbl>::create_table(*session,
+        sw::fields_query<bench_tbl>::id = sw::primary_key_constraint);
+
+    sw::ddl<bench_decode_tbl>::drop_table(*session);
+    sw::ddl<bench_decode_tbl>::create_table(*session);
+
+    sw::ddl<bench_page_tbl>::drop_table(*session);
+    sw::ddl<bench_page_tbl>::create_table(*session,
+        sw::fields_query<bench_page_tbl>::id = sw::primary_key_constraint);
+}
@@ -0,0 +1,201 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE dml
+
+#include "soci-wrapper.hpp"
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <ranges>
+#include <thread>
+
+#if defined(SW_SQLITE)
+constexpr bool sw_sqlite = true;
+#else
+constexpr bool sw_sqlite = false;
+#endif
+
+namespace sw = soci_wrapper;
+namespace utf = boost::unit_test;
+
+sw::session::session_ptr_type session;
+
+struct dml_tbl {
+    int id;
+    std::string name;
+    std::array<char, 6> code;
+};
+
+struct dml_ai_tbl {
+    int ai_id;
+    std::string value;
+};
+
+DECLARE_PERSISTENT_OBJECT(dml_tbl,
+    id,
+    name,
+    code);
+
+DECLARE_PERSISTENT_OBJECT(dml_ai_tbl,
+    ai_id,
+    value);
+
+static const int rows_number = 2500;
+
+BOOST_AUTO_TEST_CASE(tst_persist_range, *utf::depends_on("tst_batch_writer"))
+{
+    // More rows than fit into a single statement, with a tail
+    const int first = rows_number * 2;
+    const int size = sw::dml::values_chunk_size<dml_tbl> * 2 + 7;
+    const int rows = sw::dql::query_from<dml_tbl>().count(*session);
+
+    std::vector<dml_tbl> objects;
+    for (int idx = first; idx < first + size; ++idx) {
+        objects.push_back({ .id = idx,
+            .name = "range " + std::to_string(idx),
+            .code { "range" } });
+    }
+
+    sw::dml::persist(*session, objects);
+    BOOST_TEST(sw::dql::query_from<dml_tbl>().count(*session) == rows + size);
+
+    std::vector<dml_tbl> data = sw::dql::query_from<dml_tbl>()
+                                    .where(sw::fields_query<dml_tbl>::id >= first)
+                                    .orderByAsc(sw::fields_query<dml_tbl>::id)
+                                    .objects(*session);
+    BOOST_TEST(data.size() == size);
+    for (int idx = 0; idx < data.size(); ++idx) {
+        BOOST_TEST(data[idx].id == objects[idx].id);
+        BOOST_TEST(data[idx].name == objects[idx].name);
+        BOOST_TEST(data[idx].code == objects[idx].code);
+    }
+
+    // A failing chunk rolls the whole range back, the chunks written before it too:
+    // the duplicated key is in the tail, past the first two chunks
+    std::vector<dml_tbl> duplicated;
+    for (int idx = first + size; idx < first + 2 * size - 1; ++idx) {
+        duplicated.push_back({ .id = idx,
+            .name = "range " + std::to_string(idx),
+            .code { "range" } });
+    }
+    duplicated.push_back(objects.front());
+
+    BOOST_CHECK_THROW(sw::dml::persist(*session, duplicated), std::exception);
+    BOOST_TEST(sw::dql::query_from<dml_tbl>().count(*session) == rows + size);
+    BOOST_TEST(sw::dql::query_from<dml_tbl>().where(sw::fields_query<dml_tbl>::id >= first + size).count(*session) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(tst_batch_writer, *utf::depends_on("tst_persist_bulk_rollback"))
+{
+    // The commits are observed by another connection, the writer's one sees its pending rows too
+    auto other = sw::session::connect("tst_object.db");
+
+    const int first = rows_number + 100;
+    {
+        sw::dml::batch_writer<dml_tbl> writer(*session, { .rows = 10 });
+        for (int idx = first; idx < first + 25; ++idx) {
+            writer.persist({ .id = idx, .name = "batch", .code { "batch" } });
+        }
+        // Two batches are committed, the rest is pending till the destruction
+        BOOST_TEST(writer.pending() == 5);
+        BOOST_TEST(sw::dql::query_from<dml_tbl>().count(*other) == rows_number + 20);
+    }
+    BOOST_TEST(sw::dql::query_from<dml_tbl>().count(*other) == rows_number + 25);
+
+    {
+        sw::dml::batch_writer<dml_tbl> writer(*session, { .rows = 10 });
+        writer.persist({ .id = first + 100, .name = "batch", .code { "batch" } });
+
+        // The duplicated key rolls the pending batch back
+        BOOST_CHECK_THROW(writer.persist({ .id = first, .name = "batch", .code { "batch" } }), std::exception);
+        BOOST_TEST(writer.pending() == 0);
+    }
+    BOOST_TEST(sw::dql::query_from<dml_tbl>().count(*other) == rows_number + 25);
+
+    {
+        // The interval elapsed, every write is committed
+        sw::dml::batch_writer<dml_tbl> writer(*session, { .rows = 10, .interval = std::chrono::milliseconds { 0 } });
+        writer.persist({ .id = first + 200, .name = "batch", .code { "batch" } });
+        BOOST_TEST(writer.pending() == 0);
+        BOOST_TEST(sw::dql::query_from<dml_tbl>().count(*other) == rows_number + 26);
+    }
+
+    {
+        // An idle writer commits by poll() once the interval has elapsed
+        sw::dml::batch_writer<dml_tbl> writer(*session, { .rows = 10, .interval = std::chrono::milliseconds { 10 } });
+        writer.persist({ .id = first + 300, .name = "batch", .code { "batch" } });
+        BOOST_TEST(writer.pending() == 1);
+        BOOST_TEST(sw::dql::query_from<dml_tbl>().count(*other) == rows_number + 26);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds { 20 });
+        BOOST_TEST(writer.poll());
+        BOOST_TEST(not writer.poll());
+        BOOST_TEST(writer.pending() == 0);
+        BOOST_TEST(sw::dql::query_from<dml_tbl>().count(*other) == rows_number + 27);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(tst_persist_bulk_autoincrement, *utf::depends_on("tst_conn"))
+{
+    auto objects = std::views::iota(0, 10) | std::views::transform([](int idx) {
+        return dml_ai_tbl { .ai_id = -1, .value = "value " + std::to_string(idx) };
+    });
+
+    sw::dml::persist_bulk(*session, objects, 3);
+
+    std::vector<dml_ai_tbl> data = sw::dql::query_from<dml_ai_tbl>()
+                                       .orderByAsc(sw::fields_query<dml_ai_tbl>::ai_id)
+                                       .objects(*session);
+    BOOST_TEST(data.size() == 10);
+    for (int idx = 0; idx < data.size(); ++idx) {
+        BOOST_TEST(data[idx].ai_id == idx + 1);
+        BOOST_TEST(data[idx].value == "value " + std::to_string(idx));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(tst_persist_bulk_rollback, *utf::depends_on("tst_persist_bulk"))
+{
+    // The duplicated primary key breaks the last chunk, nothing of the call should be stored
+    std::vector<dml_tbl> objects {
+        { .id = rows_number, .name = "new", .code { "new" } },
+        { .id = 0, .name = "duplicate", .code { "dup" } }
+    };
+
+    BOOST_CHECK_THROW(sw::dml::persist_bulk(*session, objects, 1), std::exception);
+    BOOST_TEST(sw::dql::query_from<dml_tbl>().count(*session) == rows_number);
+}
+
+BOOST_AUTO_TEST_CASE(tst_persist_bulk, *utf::depends_on("tst_conn"))
+{
+    std::vector<dml_tbl> objects;
+    for (int idx = 0; idx < rows_number; ++idx) {
+        objects.push_back({ .id = idx,
+            .name = "name " + std::to_string(idx),
+            .code { "code" } });
+    }
+
+    sw::dml::persist_bulk(*session, objects);
+    BOOST_TEST(sw::dql::query_from<dml_tbl>().count(*session) == rows_number);
+
+    std::vector<dml_tbl> data = sw::dql::query_from<dml_tbl>()
+                                    .orderByAsc(sw::fields_query<dml_tbl>::id)
+                                    .objects(*session);
+    BOOST_TEST(data.size() == rows_number);
+    for (int idx = 0; idx < data.size(); ++idx) {
+        BOOST_TEST(data[idx].id == idx);
+        BOOST_TEST(data[idx].name == objects[idx].name);
+        BOOST_TEST(data[idx].code == objects[idx].code);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(tst_conn, *utf::enable_if<sw_sqlite>())
+{
+    session = sw::session::connect("tst_object.db");
+    BOOST_TEST(session->is_connected());
+
+    sw::ddl<dml_tbl>::drop_table(*session);
+    sw::ddl<dml_tbl>::create_table(*session,
+        sw::fields_query<dml_tbl>::id = sw::primary_key_constraint);
+
+    sw::ddl<dml_ai_tbl>::drop_table(*session);
+    sw::ddl<dml_ai_tbl>::create_table(*session,
+        sw::fields_query<dml_ai_tbl>::ai_id = sw::auto_increment_constraint);
+}
@@ -4,6 +4,7 @@
 #include "soci-wrapper.hpp"
 #include <array>
 #include <boost/test/unit_test.hpp>
+#include <stdexcept>
 
 #if defined(SW_SQLITE)
 constexpr bool sw_sqlite = true;
@@ -68,6 +69,58 @@ BOOST_AUTO_TEST_CASE(tst_limit_offset, *utf::depends_on("tst_populate"))
     }
 }
 
+BOOST_AUTO_TEST_CASE(tst_keyset_pages, *utf::depends_on("tst_populate"))
+{
+    using fields = sw::fields_query<person>;
+
+    // A page sought after the last key, the conditions of where() are kept
+    const auto page = sw::dql::query_from<person>()
+                          .where(fields::id < 3)
+                          .disjunction(fields::id > 20)
+                          .after(fields::id, 1)
+                          .limit(3)
+                          .objects(*session);
+    BOOST_TEST(page.size() == 3);
+    BOOST_TEST(page.front().id == 2);
+    BOOST_TEST(page.back().id == 22);
+
+    const auto previous = sw::dql::query_from<person>()
+                              .before(fields::id, 10)
+                              .limit(2)
+                              .objects(*session);
+    BOOST_TEST(previous.size() == 2);
+    BOOST_TEST(previous.front().id == 9);
+    BOOST_TEST(previous.back().id == 8);
+
+    std::vector<size_t> sizes;
+    int expected = 0;
+    auto pages = sw::dql::query_from<person>().pages(*session, fields::id, 10);
+    for (const std::vector<person>& objects : pages) {
+        sizes.push_back(objects.size());
+        for (const person& prsn : objects)
+            BOOST_TEST(prsn.id == expected++);
+    }
+    BOOST_TEST((sizes == std::vector<size_t> { 10, 10, 5 }));
+    BOOST_TEST(*pages.last_key() == 24);
+
+    // Resuming where a previous pager stopped, in the descending order
+    sizes.clear();
+    for (const auto& objects : sw::dql::query_from<person>().before(fields::id, 5).pages(*session, fields::id, 2)) {
+        sizes.push_back(objects.size());
+        BOOST_TEST(objects.front().id == 4 - 2 * static_cast<int>(sizes.size() - 1));
+    }
+    BOOST_TEST((sizes == std::vector<size_t> { 2, 2, 1 }));
+
+    // Ordered by the key first, in the direction of the seek; another order would skip or repeat the rows
+    BOOST_TEST(sw::dql::query_from<person>().orderByAsc(fields::id, fields::name).after(fields::id, 20).objects(*session).size() == 4);
+    BOOST_CHECK_THROW(sw::dql::query_from<person>().orderByAsc(fields::name).after(fields::id, 20).objects(*session),
+        std::logic_error);
+    BOOST_CHECK_THROW(sw::dql::query_from<person>().orderByAsc(fields::id).before(fields::id, 20).objects(*session),
+        std::logic_error);
+    BOOST_CHECK_THROW(sw::dql::query_from<person>().orderByDesc(fields::name).pages(*session, fields::id, 10),
+        std::logic_error);
+}
+
 BOOST_AUTO_TEST_CASE(tst_order, *utf::depends_on("tst_populate"))
 {
     std::vector<person> data = sw::dql::query_from<person>()
@@ -134,6 +187,278 @@ BOOST_AUTO_TEST_CASE(tst_data, *utf::depends_on("tst_populate"))
         (sw::dql::query_from<data_types>().objects(*session)[0] == dt));
 }
 
+BOOST_AUTO_TEST_CASE(tst_stream, *utf::depends_on("tst_populate"))
+{
+    int idx = 0;
+    for (const person& prsn : sw::dql::query_from<person>().stream(*session, 4)) {
+        BOOST_TEST(prsn.id == idx);
+        BOOST_TEST(prsn.name == "name " + std::to_string(idx));
+        ++idx;
+    }
+    BOOST_TEST(idx == 25);
+
+    auto cursor = sw::dql::query_from<person>()
+                      .where(sw::fields_query<person>::id >= 20)
+                      .stream(*session, 2);
+    static_assert(std::ranges::input_range<decltype(cursor)>);
+
+    std::vector<int> ids;
+    for (auto it = cursor.begin(); it != cursor.end(); ++it) {
+        ids.push_back(it->id);
+    }
+    BOOST_TEST(ids == std::vector<int>({ 20, 21, 22, 23, 24 }));
+
+    auto empty = sw::dql::query_from<person>()
+                     .where(sw::fields_query<person>::id > 100)
+                     .stream(*session);
+    BOOST_TEST((empty.begin() == empty.end()));
+}
+
+BOOST_AUTO_TEST_CASE(tst_columns, *utf::depends_on("tst_populate"))
+{
+    auto rows = sw::dql::query_from<person>()
+                          .orderByAsc(sw::fields_query<person>::id)
+                          .columns(*session, 10);
+    BOOST_TEST(rows.size() == 25);
+
+    // A column is a contiguous vector accessed by the DSL field
+    const std::vector<int>& ids = rows[sw::fields_query<person>::id];
+    const std::vector<std::string_view>& names = rows[sw::fields_query<person>::name];
+    int sum = 0;
+    for (int id : ids)
+        sum += id;
+    BOOST_TEST(sum == 24 * 25 / 2);
+    BOOST_TEST(names[7] == "name 7");
+    BOOST_TEST(rows.get<2>()[24] == "surname 24");
+    BOOST_TEST(rows.strings().blocks() == 1);
+
+    const person prsn { .id = 20, .name = "name 20", .surname = "surname 20" };
+    BOOST_TEST((rows.object(20) == prsn));
+
+    // The views survive moving the container
+    auto moved = std::move(rows);
+    BOOST_TEST(moved[sw::fields_query<person>::surname][3] == "surname 3");
+
+    const auto types = sw::dql::query_from<data_types>().columns(*session);
+    BOOST_TEST(types.size() == 1);
+    BOOST_TEST(types[sw::fields_query<data_types>::cpp_arr][0] == "ABCDE");
+    BOOST_TEST((types.object(0) == dt));
+}
+
+BOOST_AUTO_TEST_CASE(tst_projection, *utf::depends_on("tst_populate"))
+{
+    using fields = sw::fields_query<person>;
+
+    const auto rows = sw::dql::query_from<person>()
+                          .where(fields::id >= 20)
+                          .orderByDesc(fields::id)
+                          .select(fields::id, fields::surname)
+                          .tuples(*session, 2);
+    BOOST_TEST(rows.size() == 5);
+    BOOST_TEST(std::get<0>(rows.front()) == 24);
+    BOOST_TEST(std::get<1>(rows.front()) == "surname 24");
+    BOOST_TEST(std::get<0>(rows.back()) == 20);
+
+    // A lighter struct, the members in the order of the selection
+    struct person_name {
+        std::string name;
+        int id;
+    };
+    const auto names = sw::dql::query_from<person>()
+                           .orderByAsc(fields::id)
+                           .select(fields::name, fields::id)
+                           .as<person_name>(*session);
+    BOOST_TEST(names.size() == 25);
+    BOOST_TEST(names[7].name == "name 7");
+    BOOST_TEST(names[7].id == 7);
+
+    const auto types = sw::dql::query_from<data_types>()
+                           .select(sw::fields_query<data_types>::cpp_arr, sw::fields_query<data_types>::f_int)
+                           .tuples(*session);
+    BOOST_TEST(types.size() == 1);
+    BOOST_TEST((std::get<0>(types.front()) == dt.cpp_arr));
+    BOOST_TEST(std::get<1>(types.front()) == dt.f_int);
+}
+
+BOOST_AUTO_TEST_CASE(tst_kernels, *utf::depends_on("tst_columns"))
+{
+    namespace kernels = sw::kernels;
+
+    const auto rows = sw::dql::query_from<person>().columns(*session);
+    const std::vector<int>& ids = rows[sw::fields_query<person>::id];
+
+    // Every instruction set up to the supported one gives the results of the scalar code
+    std::vector<double> values;
+    for (int idx = 0; idx < 1003; ++idx)
+        values.push_back((idx * 37 % 101) - 50.5);
+
+    for (int isa = 0; isa <= static_cast<int>(kernels::supported_isa()); ++isa) {
+        kernels::select_isa(static_cast<kernels::isa>(isa));
+
+        BOOST_TEST(kernels::sum(ids) == 24 * 25 / 2);
+        BOOST_TEST(*kernels::min(ids) == 0);
+        BOOST_TEST(*kernels::max(ids) == 24);
+        BOOST_TEST(kernels::count(ids, kernels::compare::greater_equal, 20) == 5);
+
+        kernels::mask_type mask;
+        BOOST_TEST(kernels::filter_mask(ids, kernels::compare::less, 10, mask) == 10);
+        BOOST_TEST(mask.size() == ids.size());
+        BOOST_TEST(kernels::sum(ids, mask) == 9 * 10 / 2);
+
+        kernels::mask_type odd(ids.size());
+        for (size_t idx = 0; idx < ids.size(); ++idx)
+            odd[idx] = ids[idx] % 2;
+        BOOST_TEST(kernels::mask_and(mask, odd) == 5);
+        BOOST_TEST(kernels::sum(ids, mask) == 1 + 3 + 5 + 7 + 9);
+
+        const auto tail = kernels::sum_if(ids, kernels::compare::greater, 19);
+        BOOST_TEST(tail.sum == 20 + 21 + 22 + 23 + 24);
+        BOOST_TEST(tail.count == 5);
+
+        double sum = 0;
+        size_t negative = 0;
+        for (double value : values) {
+            sum += value;
+            negative += value < 0;
+        }
+        BOOST_TEST(kernels::sum(values) == sum, boost::test_tools::tolerance(1e-9));
+        BOOST_TEST(*kernels::min(values) == -50.5);
+        BOOST_TEST(*kernels::max(values) == 50.5);
+        BOOST_TEST(kernels::count(values, kernels::compare::less, 0.0) == negative);
+        BOOST_TEST(kernels::count(values, kernels::compare::equal, 0.5) == 10);
+        BOOST_TEST(kernels::sum_if(values, kernels::compare::not_equal, 0.5).count == values.size() - 10);
+        BOOST_TEST(not kernels::min(std::vector<double>()).has_value());
+
+        // The sum of std::int32_t is widened, it does not overflow
+        const std::vector<int> large(9, std::numeric_limits<int>::max());
+        BOOST_TEST(kernels::sum(large) == 9LL * std::numeric_limits<int>::max());
+    }
+    kernels::select_isa(kernels::supported_isa());
+}
+
+BOOST_AUTO_TEST_CASE(tst_fetch_chunks, *utf::depends_on("tst_populate"))
+{
+    // The chunks are filled up to the fetch size, the last one holds the rest
+    std::vector<size_t> sizes;
+    std::vector<int> ids;
+    std::vector<std::string> surnames;
+    sw::dql::query_from<person>()
+        .orderByAsc(sw::fields_query<person>::id)
+        .for_each_chunk(*session, [&](sw::query::column_chunk<person>& chunk) {
+            sizes.push_back(chunk.size());
+            const auto& id = std::get<0>(chunk.columns);
+            const auto& surname = std::get<2>(chunk.columns);
+            ids.insert(ids.end(), id.begin(), id.end());
+            surnames.insert(surnames.end(), surname.begin(), surname.end());
+        }, 10);
+    BOOST_TEST(sizes == std::vector<size_t>({ 10, 10, 5 }));
+    BOOST_TEST(ids.size() == 25);
+    for (int idx = 0; idx < static_cast<int>(ids.size()); ++idx) {
+        BOOST_TEST(ids[idx] == idx);
+        BOOST_TEST(surnames[idx] == "surname " + std::to_string(idx));
+    }
+
+    // The objects are the same whatever the fetch size
+    for (size_t fetch_size : { 1, 7, 25, 1000 }) {
+        BOOST_TEST((sw::dql::query_from<person>().objects(*session, fetch_size) == sw::dql::query_from<person>().objects(*session)));
+    }
+    BOOST_TEST((sw::dql::query_from<data_types>().objects(*session, 3)[0] == dt));
+}
+
+BOOST_AUTO_TEST_CASE(tst_bound_literals, *utf::depends_on("tst_populate"))
+{
+    auto& cache = session->statements();
+    const size_t misses = cache.misses();
+
+    for (int idx = 0; idx < 25; ++idx) {
+        person prsn = sw::dql::query_from<person>()
+                          .where(sw::fields_query<person>::id == idx)
+                          .conjunction(sw::fields_query<person>::name == "name " + std::to_string(idx))
+                          .object(*session);
+        BOOST_TEST(prsn.id == idx);
+        BOOST_TEST(prsn.surname == "surname " + std::to_string(idx));
+    }
+
+    // The queries differing by the values share the same statement
+    BOOST_TEST(cache.misses() == misses + 1);
+
+    // The quotes are not a part of the SQL text anymore
+    BOOST_TEST(sw::dql::query_from<person>()
+                   .where(sw::fields_query<person>::name == std::string_view { "name ' 20" })
+                   .count(*session)
+        == 0);
+}
+
+BOOST_AUTO_TEST_CASE(tst_statement_cache_reconnect, *utf::depends_on("tst_statement_cache_done"))
+{
+    auto& cache = session->statements();
+    BOOST_TEST(sw::dql::query_from<person>().count(*session) == 25);
+    BOOST_TEST(cache.size() > 0);
+
+    // The statements of the released connection are dropped and prepared again on the new one
+    const size_t misses = cache.misses();
+    session->reconnect();
+    BOOST_TEST(cache.size() == 0);
+    BOOST_TEST(sw::dql::query_from<person>().count(*session) == 25);
+    BOOST_TEST(cache.misses() == misses + 1);
+
+    session->close();
+    BOOST_TEST(cache.size() == 0);
+    session->open(
+#ifdef SW_SQLITE
+        soci::sqlite3,
+#endif
+        "tst_object.db");
+    BOOST_TEST(sw::dql::query_from<person>().count(*session) == 25);
+    BOOST_TEST(cache.misses() == misses + 2);
+}
+
+BOOST_AUTO_TEST_CASE(tst_statement_cache_done, *utf::depends_on("tst_statement_cache"))
+{
+    auto other = sw::session::connect("tst_object.db");
+
+    // The cached SELECTs are run to their end, the session keeps no read transaction
+    sw::dql::query_from<person>().object(*session);
+    BOOST_TEST(sw::dql::query_from<person>().count(*session) == 25);
+    BOOST_TEST(sw::dql::query_from<person>().objects(*session, 10).size() == 25);
+    BOOST_CHECK_NO_THROW(*other << "CREATE TABLE tst_unlocked (id INTEGER)");
+    BOOST_CHECK_NO_THROW(*session << "DROP TABLE tst_unlocked");
+
+    // Nor if the results are left by an exception
+    BOOST_CHECK_THROW(sw::dql::query_from<person>().for_each_chunk(*session, [](auto&) {
+        throw std::runtime_error("stop");
+    }, 2),
+        std::runtime_error);
+    BOOST_CHECK_NO_THROW(*other << "CREATE TABLE tst_unlocked (id INTEGER)");
+    BOOST_CHECK_NO_THROW(*session << "DROP TABLE tst_unlocked");
+}
+
+BOOST_AUTO_TEST_CASE(tst_statement_cache, *utf::depends_on("tst_populate"))
+{
+    auto& cache = session->statements();
+    cache.clear();
+
+    const size_t hits = cache.hits();
+    const size_t misses = cache.misses();
+
+    for (int idx = 0; idx < 10; ++idx) {
+        BOOST_TEST(sw::dql::query_from<person>().count(*session) == 25);
+    }
+
+    BOOST_TEST(cache.misses() == misses + 1);
+    BOOST_TEST(cache.hits() == hits + 9);
+    BOOST_TEST(cache.size() == 1);
+
+    // The least recently used statement is evicted
+    cache.capacity(1);
+    BOOST_TEST(sw::dql::query_from<person>().objects(*session).size() == 25);
+    BOOST_TEST(cache.size() == 1);
+    BOOST_TEST(sw::dql::query_from<person>().count(*session) == 25);
+    BOOST_TEST(cache.misses() == misses + 3);
+
+    cache.capacity(sw::base::statement_cache::default_capacity);
+}
+
 BOOST_AUTO_TEST_CASE(tst_populate, *utf::depends_on("tst_conn"))
 {
     for (int idx = 0; idx < 25; ++idx) {
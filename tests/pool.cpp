@@ -2,8 +2,17 @@
 #define BOOST_TEST_MODULE pool
 
 #include "soci-wrapper.hpp"
+#include <array>
+#include <atomic>
 #include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include <future>
 #include <list>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #if defined(SW_SQLITE)
 constexpr bool sw_sqlite = true;
@@ -18,6 +27,25 @@ using sessions_pool = sw::sessions_pool<sw::session>;
 static sessions_pool::ptr_type pool;
 static const size_t conn_size = 8;
 static std::list<sessions_pool::session_proxy> proxies;
+static std::atomic<size_t> allocations = 0;
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (void* ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc {};
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
 
 struct db_table {
     int id;
@@ -31,6 +59,401 @@ DECLARE_PERSISTENT_OBJECT(db_table,
     id,
     name);
 
+BOOST_AUTO_TEST_CASE(tst_rw_pool, *utf::depends_on("tst_session_ddl_dql"))
+{
+    using rw_sessions_pool = sw::rw_sessions_pool<sw::session>;
+    using session_raw_type = rw_sessions_pool::session_raw_type;
+
+    static const int first = 5000;
+    static const int writers_number = 4;
+    static const int rows_number = 100;
+
+    const auto count = [](session_raw_type& session) {
+        return sw::dql::query_from<db_table>()
+            .where(sw::fields_query<db_table>::id >= first && sw::fields_query<db_table>::id <= first + writers_number * rows_number)
+            .count(session);
+    };
+
+    auto rw = rw_sessions_pool::create("tst_object.db", { .readers = 4, .group_size = 64 });
+    BOOST_TEST(rw->readers()->size() == 4);
+    const int rows = rw->read(count);
+
+    // The writers are queued instead of competing for the database lock
+    std::vector<std::thread> writers;
+    std::atomic<size_t> failures = 0;
+    for (int writer = 0; writer < writers_number; ++writer) {
+        writers.emplace_back([&rw, &failures, writer] {
+            std::vector<std::future<void>> written;
+            for (int id = first + writer * rows_number; id < first + (writer + 1) * rows_number; ++id) {
+                written.push_back(rw->write([object = db_table { .id = id, .name = "rw" }](session_raw_type& session) {
+                    sw::dml::persist(session, object);
+                }));
+            }
+            for (auto& future : written) {
+                try {
+                    future.get();
+                } catch (...) {
+                    ++failures;
+                }
+            }
+        });
+    }
+    for (auto& writer : writers)
+        writer.join();
+    BOOST_TEST(failures == 0);
+
+    // A failed job is rolled back alone, the rest of its group is committed
+    auto failed = rw->write([](session_raw_type& session) -> int {
+        sw::dml::persist(session, db_table { .id = first, .name = "rolled back" });
+        throw std::runtime_error("failed job");
+    });
+    auto succeeded = rw->write([](session_raw_type& session) {
+        sw::dml::persist(session, db_table { .id = first + writers_number * rows_number, .name = "rw" });
+        return 42;
+    });
+    BOOST_CHECK_THROW(failed.get(), std::runtime_error);
+    BOOST_TEST(succeeded.get() == 42);
+
+    BOOST_TEST(rw->read(count) == rows + writers_number * rows_number + 1);
+    BOOST_TEST(rw->pending() == 0);
+
+    const auto statistics = rw->statistics();
+    BOOST_TEST(statistics.jobs == writers_number * rows_number + 2);
+    BOOST_TEST(statistics.failed_jobs == 1);
+    BOOST_TEST(statistics.failed_commits == 0);
+    BOOST_TEST(statistics.commits <= statistics.jobs);
+
+    // read() gives up once all the readers stay busy for its timeout
+    std::vector<rw_sessions_pool::session_proxy> busy;
+    for (int reader = 0; reader < 4; ++reader)
+        busy.push_back(rw->get_reader());
+    BOOST_CHECK_THROW(rw->read(count, std::chrono::milliseconds { 10 }), std::runtime_error);
+}
+
+struct metrics_counter : sessions_pool::metrics_sink {
+    void exhausted(const sessions_pool&) override
+    {
+        ++exhaustions;
+    }
+
+    void report(const sessions_pool::metrics_type& metrics) override
+    {
+        last_total = metrics.total;
+        ++reports;
+    }
+
+    std::atomic<size_t> exhaustions = 0;
+    std::atomic<size_t> reports = 0;
+    std::atomic<size_t> last_total = 0;
+};
+
+BOOST_AUTO_TEST_CASE(tst_pool_metrics, *utf::depends_on("tst_session_ddl_dql"))
+{
+    using namespace std::chrono_literals;
+
+    // The sink outlives the pool, whose maintenance thread might be reporting to it
+    metrics_counter sink;
+    auto measured = sessions_pool::create("tst_object.db",
+        { .min_size = 2, .max_size = 2, .maintenance_interval = 10ms });
+    measured->set_metrics_sink(&sink);
+
+    {
+        auto first = measured->get_session();
+        auto second = measured->get_session();
+        BOOST_TEST(measured->metrics().checked_out == 2);
+        BOOST_TEST(measured->metrics().idle == 0);
+
+        // The pool is exhausted, the waiting checkout times out
+        BOOST_TEST(!measured->get_session().is_connected());
+        BOOST_TEST(!measured->get_session(1ms).has_value());
+        BOOST_TEST(sink.exhaustions == 2);
+
+        std::this_thread::sleep_for(2ms);
+    }
+
+    const size_t before = allocations;
+    const auto metrics = measured->metrics();
+    BOOST_TEST(allocations == before);
+
+    BOOST_TEST(metrics.checked_out == 0);
+    BOOST_TEST(metrics.idle == 2);
+    BOOST_TEST(metrics.total == 2);
+    BOOST_TEST(metrics.peak_checked_out == 2);
+    BOOST_TEST(metrics.exhausted == 2);
+    BOOST_TEST(metrics.wait.count == 2);
+    BOOST_TEST(metrics.hold.count == 2);
+    BOOST_TEST(metrics.hold.percentile(0.5) >= 2ms);
+    BOOST_TEST(metrics.hold.mean() >= 2ms);
+    BOOST_TEST(metrics.wait.percentile(1.0) >= metrics.wait.percentile(0.5));
+
+    for (int idx = 0; idx < 200 && sink.reports == 0; ++idx)
+        std::this_thread::sleep_for(10ms);
+    BOOST_TEST(sink.reports > 0);
+    BOOST_TEST(sink.last_total == 2);
+    measured->set_metrics_sink(nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(tst_pool_health, *utf::depends_on("tst_session_ddl_dql"))
+{
+    using namespace std::chrono_literals;
+    using session_raw_type = sessions_pool::session_raw_type;
+
+    auto admin = pool->get_session();
+    static_cast<session_raw_type&>(admin) << "CREATE TABLE IF NOT EXISTS tst_probe (id INTEGER)";
+
+    auto checked = sessions_pool::create("tst_object.db",
+        { .min_size = 2,
+            .max_size = 2,
+            .probe = "SELECT COUNT(*) FROM tst_probe",
+            .validate_on_borrow = true,
+            .validate_on_release = true,
+            .maintenance_interval = 10ms });
+
+    const auto recovered = [&checked] {
+        for (int idx = 0; idx < 200 && checked->total() < 2; ++idx)
+            std::this_thread::sleep_for(10ms);
+        return checked->total() == 2;
+    };
+
+    {
+        // A session broken while checked out is closed on release and replaced in the background
+        auto session = checked->get_session();
+        static_cast<session_raw_type&>(session).close();
+    }
+    BOOST_TEST(checked->statistics().broken == 1);
+    BOOST_TEST(recovered());
+    BOOST_TEST(checked->statistics().reconnects >= 1);
+
+    // The sessions failing the probe are not handed out
+    static_cast<session_raw_type&>(admin) << "DROP TABLE tst_probe";
+    BOOST_TEST(!checked->get_session().is_connected());
+    BOOST_TEST(checked->statistics().broken >= 3);
+
+    static_cast<session_raw_type&>(admin) << "CREATE TABLE tst_probe (id INTEGER)";
+    BOOST_TEST(recovered());
+    BOOST_TEST(checked->get_session().is_connected());
+}
+
+BOOST_AUTO_TEST_CASE(tst_fixed_pool_replacement, *utf::depends_on("tst_session_ddl_dql"))
+{
+    using namespace std::chrono_literals;
+    using session_raw_type = sessions_pool::session_raw_type;
+
+    // A fixed pool runs no maintenance, a closed session is replaced by the next checkout
+    auto fixed = sessions_pool::create(2, "tst_object.db");
+    {
+        auto session = fixed->get_session();
+        static_cast<session_raw_type&>(session).close();
+    }
+    BOOST_TEST(fixed->statistics().broken == 1);
+    BOOST_TEST(fixed->total() == 1);
+
+    auto first = fixed->get_session();
+    auto second = fixed->get_session();
+    BOOST_TEST(first.is_connected());
+    BOOST_TEST(second.is_connected());
+    BOOST_TEST(fixed->total() == 2);
+
+    // or at once for a waiter
+    std::optional<sessions_pool::session_proxy> waited;
+    std::thread waiter([&fixed, &waited] {
+        waited = fixed->get_session(10s);
+    });
+    while (fixed->statistics().waits == 0)
+        std::this_thread::yield();
+    static_cast<session_raw_type&>(first).close();
+    first.release();
+    waiter.join();
+    BOOST_TEST(waited.has_value());
+    BOOST_TEST(waited->is_connected());
+    BOOST_TEST(fixed->total() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(tst_proxy_no_allocations, *utf::depends_on("tst_session_ddl_dql"))
+{
+    using namespace std::chrono_literals;
+
+    const size_t cycles = 1'000'000;
+    size_t failures = 0;
+
+    const size_t before = allocations;
+    for (size_t cycle = 0; cycle < cycles; ++cycle) {
+        auto session = pool->get_session();
+        auto moved = std::move(session);
+        failures += session.is_connected() || !moved.is_connected();
+
+        auto waited = pool->get_session(1s);
+        failures += !waited.has_value();
+        waited->release();
+        failures += waited->is_connected();
+    }
+    BOOST_TEST(allocations == before);
+    BOOST_TEST(failures == 0);
+    BOOST_TEST(pool->size() == conn_size);
+
+    // A checkout from an empty pool hands out a null proxy
+    std::vector<sessions_pool::session_proxy> taken;
+    taken.reserve(conn_size);
+    while (pool->size())
+        taken.push_back(pool->get_session());
+
+    const size_t dry = allocations;
+    for (size_t cycle = 0; cycle < cycles; ++cycle)
+        failures += pool->get_session().is_connected();
+    BOOST_TEST(allocations == dry);
+    BOOST_TEST(failures == 0);
+
+    taken.clear();
+    BOOST_TEST(pool->size() == conn_size);
+}
+
+BOOST_AUTO_TEST_CASE(tst_elastic_pool, *utf::depends_on("tst_session_ddl_dql"))
+{
+    using namespace std::chrono_literals;
+
+    auto elastic = sessions_pool::create("tst_object.db", { .min_size = 2, .max_size = 4, .idle_ttl = 50ms });
+    BOOST_TEST(elastic->total() == 2);
+    BOOST_TEST(elastic->size() == 2);
+
+    {
+        // The pool grows while all the sessions are busy, up to max_size
+        std::list<sessions_pool::session_proxy> taken;
+        for (int idx = 0; idx < 4; ++idx) {
+            taken.emplace_back(elastic->get_session());
+            BOOST_TEST(taken.back().is_connected());
+        }
+        BOOST_TEST(!elastic->get_session().is_connected());
+        BOOST_TEST(elastic->total() == 4);
+        BOOST_TEST(elastic->statistics().grown == 2);
+    }
+    BOOST_TEST(elastic->size() == 4);
+
+    // The reaper closes the idle sessions down to min_size
+    for (int idx = 0; idx < 200 && elastic->total() > 2; ++idx)
+        std::this_thread::sleep_for(10ms);
+    BOOST_TEST(elastic->total() == 2);
+    BOOST_TEST(elastic->size() == 2);
+    BOOST_TEST(elastic->statistics().reaped == 2);
+    BOOST_TEST(elastic->get_session(10ms).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(tst_thread_affinity, *utf::depends_on("tst_session_ddl_dql"))
+{
+    using session_raw_type = sessions_pool::session_raw_type;
+
+    auto affine = sessions_pool::create(2, "tst_object.db", true);
+
+    session_raw_type* own = nullptr;
+    {
+        auto session = affine->get_session();
+        own = &static_cast<session_raw_type&>(session);
+    }
+    BOOST_TEST(affine->size() == 2);
+
+    // The released session stays with the thread
+    for (int idx = 0; idx < 3; ++idx) {
+        auto session = affine->get_session();
+        BOOST_TEST(&static_cast<session_raw_type&>(session) == own);
+    }
+
+    // Another thread takes the ring first, then steals the cached session; it only records, Boost.Test is not thread-safe
+    session_raw_type* first_taken = nullptr;
+    session_raw_type* second_taken = nullptr;
+    size_t left = 0;
+    std::thread([&affine, &first_taken, &second_taken, &left] {
+        auto first = affine->get_session();
+        first_taken = first.is_connected() ? &static_cast<session_raw_type&>(first) : nullptr;
+
+        auto second = affine->get_session();
+        second_taken = second.is_connected() ? &static_cast<session_raw_type&>(second) : nullptr;
+        left = affine->size();
+    }).join();
+    BOOST_TEST(first_taken != nullptr);
+    BOOST_TEST(first_taken != own);
+    BOOST_TEST(second_taken == own);
+    BOOST_TEST(left == 0);
+
+    // The sessions kept by the exited thread are given back to the pool
+    BOOST_TEST(affine->size() == 2);
+    BOOST_TEST(affine->get_session().is_connected());
+    BOOST_TEST(affine->get_session(std::chrono::milliseconds { 10 }).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(tst_session_wait, *utf::depends_on("tst_session_ddl_dql"))
+{
+    using namespace std::chrono_literals;
+
+    const auto before = pool->statistics();
+    std::list<sessions_pool::session_proxy> taken;
+    while (pool->size())
+        taken.emplace_back(pool->get_session());
+
+    // The pool is dry, the wait times out
+    BOOST_TEST(!pool->get_session(10ms).has_value());
+    BOOST_TEST(pool->statistics().timeouts == before.timeouts + 1);
+
+    // The waiters are served in the arrival order
+    // The waiters only record, Boost.Test is not thread-safe
+    std::vector<int> served;
+    std::array<bool, 2> connected {};
+    std::vector<std::thread> waiters;
+    for (int idx = 0; idx < 2; ++idx) {
+        waiters.emplace_back([&served, &connected, idx] {
+            auto session = pool->get_session(10s);
+            connected[idx] = session.has_value() and session->is_connected();
+            served.push_back(idx);
+        });
+        while (pool->statistics().waits != before.waits + idx + 2)
+            std::this_thread::yield();
+    }
+
+    taken.pop_front();
+    waiters[0].join();
+    waiters[1].join();
+    BOOST_TEST(connected[0]);
+    BOOST_TEST(connected[1]);
+    BOOST_TEST(served == std::vector<int>({ 0, 1 }));
+
+    taken.clear();
+    BOOST_TEST(pool->size() == conn_size);
+
+    const auto after = pool->statistics();
+    BOOST_TEST(after.dry == before.dry + 3);
+    BOOST_TEST(after.waits == before.waits + 3);
+    BOOST_TEST(after.wait_time > before.wait_time);
+}
+
+BOOST_AUTO_TEST_CASE(tst_session_batch_writer, *utf::depends_on("tst_session_ddl_dql"))
+{
+    const int rows = sw::dql::query_from<db_table>().count(pool->get_session());
+    {
+        sw::dml::batch_writer<db_table> writer(pool->get_session(), { .rows = 2 });
+        BOOST_TEST(pool->size() == conn_size - 1);
+        for (int idx = 0; idx < 3; ++idx) {
+            writer.persist({ .id = 2222 + idx, .name = "2222" });
+        }
+    }
+    BOOST_TEST(pool->size() == conn_size);
+    BOOST_TEST(sw::dql::query_from<db_table>().count(pool->get_session()) == rows + 3);
+}
+
+BOOST_AUTO_TEST_CASE(tst_session_stream, *utf::depends_on("tst_session_ddl_dql"))
+{
+    {
+        // The cursor owns the session proxy until it goes out of scope
+        auto cursor = sw::dql::query_from<db_table>().stream(pool->get_session());
+        BOOST_TEST(pool->size() == conn_size - 1);
+
+        size_t rows = 0;
+        for (const db_table& row : cursor) {
+            BOOST_TEST(row.name == "1111");
+            ++rows;
+        }
+        BOOST_TEST(rows >= 1);
+    }
+    BOOST_TEST(pool->size() == conn_size);
+}
+
 BOOST_AUTO_TEST_CASE(tst_session_ddl_dql, *utf::depends_on("tst_session_proxy"))
 {
     sw::ddl<db_table>::create_table(pool->get_session());
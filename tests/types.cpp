@@ -4,10 +4,92 @@
 #include "soci-wrapper/types_convertor.hpp"
 #include <array>
 #include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include <new>
 #include <tuple>
 
 using namespace soci_wrapper;
 
+static size_t allocations = 0;
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (void* ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc {};
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+struct meta_tbl {
+    int id;
+    double value;
+    std::string name;
+    std::array<char, 16> code;
+};
+
+DECLARE_PERSISTENT_OBJECT(meta_tbl,
+    id,
+    value,
+    name,
+    code);
+
+using meta_data = details::type_meta_data<meta_tbl>;
+
+BOOST_AUTO_TEST_CASE(tst_constexpr_meta_data)
+{
+    static_assert(meta_data::table_name() == "meta_tbl");
+    static_assert(meta_data::member_names().size() == meta_data::fields_number::value);
+    static_assert(meta_data::member_names()[2] == "name");
+    static_assert(meta_data::field_index("code") == 3);
+    static_assert(meta_data::field_offset("value") == offsetof(meta_tbl, value));
+    static_assert(meta_data::member_offsets()[3] == offsetof(meta_tbl, code));
+    static_assert(details::db_types<meta_tbl>::value[0] == "INTEGER");
+    static_assert(details::db_types<meta_tbl>::value[1] == "REAL");
+    static_assert(details::db_types<meta_tbl>::value[2] == "VARCHAR");
+    static_assert(details::db_types<meta_tbl>::value[3] == "CHAR(16)");
+
+    BOOST_CHECK_THROW(meta_data::field_offset("unknown"), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(tst_constexpr_sql)
+{
+    static_assert(details::sql_text<meta_tbl>::insert == "INSERT INTO meta_tbl (id,value,name,code) VALUES (:id,:value,:name,:code)");
+    static_assert(details::sql_text<meta_tbl>::select == "SELECT id,value,name,code FROM meta_tbl");
+    static_assert(details::sql_text<meta_tbl>::count == "SELECT COUNT(*) FROM meta_tbl");
+    static_assert(details::sql_text<meta_tbl>::create == "CREATE TABLE IF NOT EXISTS meta_tbl (");
+    static_assert(details::sql_text<meta_tbl>::drop == "DROP TABLE IF EXISTS meta_tbl");
+    BOOST_TEST(true);
+}
+
+BOOST_AUTO_TEST_CASE(tst_meta_data_no_allocations)
+{
+    meta_tbl object { .id = 1, .value = 2.0, .name = "name", .code { "code" } };
+    size_t checksum = 0;
+
+    const size_t before = allocations;
+    for (int idx = 0; idx < 1000; ++idx) {
+        checksum += meta_data::table_name().size();
+        for (auto name : meta_data::member_names()) {
+            checksum += meta_data::field_offset(name);
+        }
+        checksum += details::member_at<0>(object);
+        checksum += details::member_at<2>(object).size();
+        checksum += configuration<meta_tbl>::auto_increment_flags()[0];
+    }
+    BOOST_TEST(allocations == before);
+    BOOST_TEST(checksum > 0);
+}
+
 BOOST_AUTO_TEST_CASE(tst_array_of_char_type)
 {
     std::array<char, 256> arr;
@@ -0,0 +1,191 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE write_behind
+
+#include "soci-wrapper.hpp"
+#include <boost/test/unit_test.hpp>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(SW_SQLITE)
+constexpr bool sw_sqlite = true;
+#else
+constexpr bool sw_sqlite = false;
+#endif
+
+namespace sw = soci_wrapper;
+namespace utf = boost::unit_test;
+using sessions_pool = sw::sessions_pool<sw::session>;
+
+sw::session::session_ptr_type session;
+sessions_pool::ptr_type pool;
+
+struct wb_tbl {
+    int id;
+    std::string name;
+};
+
+DECLARE_PERSISTENT_OBJECT(wb_tbl,
+    id,
+    name);
+
+struct wb_keyless_tbl {
+    int id;
+    std::string name;
+};
+
+DECLARE_PERSISTENT_OBJECT(wb_keyless_tbl,
+    id,
+    name);
+
+static const int threads_number = 4;
+static const int rows_number = 1000;
+
+static int count_rows(int first, int last)
+{
+    return sw::dql::query_from<wb_tbl>()
+        .where(sw::fields_query<wb_tbl>::id >= first && sw::fields_query<wb_tbl>::id < last)
+        .count(*session);
+}
+
+BOOST_AUTO_TEST_CASE(tst_error_handler, *utf::depends_on("tst_backpressure"))
+{
+    std::vector<int> failed;
+    {
+        sw::write_behind<wb_tbl> writer(pool->get_session(), { .rows = 5 },
+            [&failed](std::exception_ptr error, std::span<const wb_tbl> objects) {
+                BOOST_TEST(static_cast<bool>(error));
+                for (const wb_tbl& object : objects)
+                    failed.push_back(object.id);
+            });
+
+        // The ids were written by tst_write_behind, the whole batch is rolled back
+        for (int id = 0; id < 5; ++id)
+            writer.persist({ .id = id, .name = "duplicate" });
+        writer.flush();
+
+        BOOST_TEST(writer.failed() == 5);
+        BOOST_TEST(writer.written() == 0);
+        BOOST_TEST(writer.pending() == 0);
+    }
+    BOOST_TEST(failed == std::vector<int>({ 0, 1, 2, 3, 4 }));
+    BOOST_TEST(sw::dql::query_from<wb_tbl>().where(sw::fields_query<wb_tbl>::name == "duplicate").count(*session) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(tst_backpressure, *utf::depends_on("tst_coalesce"))
+{
+    const int first = threads_number * rows_number + 100;
+    {
+        // The queue is much smaller than the number of the objects
+        sw::write_behind<wb_tbl> writer(pool->get_session(), { .capacity = 8, .rows = 16 });
+        for (int id = first; id < first + rows_number; ++id)
+            writer.persist({ .id = id, .name = "backpressure" });
+    }
+    BOOST_TEST(count_rows(first, first + rows_number) == rows_number);
+}
+
+BOOST_AUTO_TEST_CASE(tst_coalesce_keyless, *utf::depends_on("tst_coalesce"))
+{
+    // Without a primary key all the objects would share the same key and collapse into the last one
+    BOOST_CHECK_THROW(sw::write_behind<wb_keyless_tbl>(*session, { .coalesce = true }), std::logic_error);
+
+    {
+        sw::write_behind<wb_keyless_tbl> writer(*session, { .interval = std::chrono::seconds { 60 } });
+        for (int id = 0; id < 10; ++id)
+            writer.persist({ .id = id, .name = "keyless" });
+    }
+    BOOST_TEST(sw::dql::query_from<wb_keyless_tbl>().count(*session) == 10);
+}
+
+BOOST_AUTO_TEST_CASE(tst_coalesce, *utf::depends_on("tst_write_behind"))
+{
+    const int id = threads_number * rows_number;
+
+    sw::write_behind<wb_tbl> writer(pool->get_session(),
+        { .interval = std::chrono::seconds { 60 }, .coalesce = true });
+    for (int idx = 0; idx < 10; ++idx)
+        writer.persist({ .id = id, .name = "version " + std::to_string(idx) });
+    writer.flush();
+
+    BOOST_TEST(writer.written() == 1);
+    BOOST_TEST(writer.coalesced() == 9);
+
+    auto objects = sw::dql::query_from<wb_tbl>().where(sw::fields_query<wb_tbl>::id == id).objects(*session);
+    BOOST_TEST(objects.size() == 1);
+    BOOST_TEST(objects[0].name == "version 9");
+}
+
+BOOST_AUTO_TEST_CASE(tst_write_behind, *utf::depends_on("tst_conn"))
+{
+    sw::write_behind<wb_tbl> writer(pool->get_session(), { .rows = 256 });
+    BOOST_TEST(pool->size() == 0);
+
+    std::vector<std::thread> producers;
+    for (int thread = 0; thread < threads_number; ++thread) {
+        producers.emplace_back([&writer, thread] {
+            for (int id = thread * rows_number; id < (thread + 1) * rows_number; ++id)
+                writer.persist({ .id = id, .name = "write behind" });
+        });
+    }
+    for (auto& producer : producers)
+        producer.join();
+
+    writer.flush();
+    BOOST_TEST(writer.pending() == 0);
+    BOOST_TEST(writer.written() == threads_number * rows_number);
+    BOOST_TEST(writer.failed() == 0);
+    BOOST_TEST(count_rows(0, threads_number * rows_number) == threads_number * rows_number);
+}
+
+BOOST_AUTO_TEST_CASE(tst_bounded_queue)
+{
+    sw::base::bounded_queue<int> queue(1000);
+    BOOST_TEST(queue.capacity() == 1024);
+
+    const int values_number = 100000;
+    std::atomic<long long> sum = 0;
+    std::atomic<int> popped = 0;
+
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < threads_number; ++thread) {
+        threads.emplace_back([&queue, thread] {
+            for (int value = thread; value < values_number; value += threads_number) {
+                while (not queue.try_push(value))
+                    std::this_thread::yield();
+            }
+        });
+        threads.emplace_back([&queue, &sum, &popped] {
+            int value;
+            while (popped.load() < values_number) {
+                if (queue.try_pop(value)) {
+                    sum += value;
+                    ++popped;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    BOOST_TEST(sum.load() == static_cast<long long>(values_number) * (values_number - 1) / 2);
+    BOOST_TEST(queue.size() == 0);
+
+    int value;
+    BOOST_TEST(not queue.try_pop(value));
+}
+
+BOOST_AUTO_TEST_CASE(tst_conn, *utf::enable_if<sw_sqlite>())
+{
+    session = sw::session::connect("tst_object.db");
+    BOOST_TEST(session->is_connected());
+
+    sw::ddl<wb_tbl>::drop_table(*session);
+    sw::ddl<wb_tbl>::create_table(*session,
+        sw::fields_query<wb_tbl>::id = sw::primary_key_constraint);
+
+    sw::ddl<wb_keyless_tbl>::drop_table(*session);
+    sw::ddl<wb_keyless_tbl>::create_table(*session);
+
+    pool = sessions_pool::create(1, "tst_object.db");
+}